@@ -0,0 +1,129 @@
+/**
+ * @brief Implements a bump allocator for simulation arrays
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "arena.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#define ARENA_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+static size_t alignSize(size_t size, size_t alignment);
+
+/**
+ * @brief Reserves capacity bytes. With hugePages the reservation is rounded
+ * to 2 MiB and backed by reserved huge pages when the system has enough,
+ * otherwise by transparent huge pages.
+ */
+Arena* constructArena(size_t capacity, bool hugePages) {
+    Arena* arena = (Arena*)malloc(sizeof(Arena));
+    if (!arena) return NULL;
+
+    capacity = alignSize(capacity > 0 ? capacity : 1, hugePages ? ARENA_HUGE_PAGE_SIZE : ARENA_ALIGNMENT);
+    arena->pages = ARENA_PAGES_REGULAR;
+
+#ifdef _WIN32
+    arena->base = (unsigned char*)_aligned_malloc(capacity, ARENA_ALIGNMENT);
+#else
+    void* address = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (hugePages) {
+        address = mmap(NULL, capacity, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (address != MAP_FAILED) arena->pages = ARENA_PAGES_EXPLICIT;
+    }
+#endif
+
+    // Pages are only committed when first touched
+    if (address == MAP_FAILED) {
+        address = mmap(NULL, capacity, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+#ifdef MADV_HUGEPAGE
+        if (address != MAP_FAILED && hugePages && madvise(address, capacity, MADV_HUGEPAGE) == 0) {
+            arena->pages = ARENA_PAGES_TRANSPARENT;
+        }
+#endif
+    }
+    arena->base = (address == MAP_FAILED) ? NULL : (unsigned char*)address;
+#endif
+
+    if (!arena->base) {
+        printf("Arena: cannot reserve %zu bytes\n", capacity);
+        free(arena);
+        return NULL;
+    }
+
+    arena->capacity = capacity;
+    arena->used = 0;
+    arena->peak = 0;
+    return arena;
+}
+
+/**
+ * @brief Returns the reservation to the system
+ */
+void destroyArena(Arena* arena) {
+    if (!arena) return;
+
+#ifdef _WIN32
+    _aligned_free(arena->base);
+#else
+    munmap(arena->base, arena->capacity);
+#endif
+    free(arena);
+}
+
+/**
+ * @brief Carves a cache-line aligned block. Returns NULL when the arena is full.
+ */
+void* allocateArena(Arena* arena, size_t size) {
+    size_t offset = alignSize(arena->used, ARENA_ALIGNMENT);
+    if (offset > arena->capacity || size > arena->capacity - offset) return NULL;
+
+    arena->used = offset + size;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    return arena->base + offset;
+}
+
+/**
+ * @brief Current position, to rewind per-step scratch allocations
+ */
+size_t markArena(const Arena* arena) {
+    return arena->used;
+}
+
+/**
+ * @brief Releases every allocation made after mark
+ */
+void rewindArena(Arena* arena, size_t mark) {
+    if (mark < arena->used) arena->used = mark;
+}
+
+/**
+ * @brief Releases every allocation in O(1). Touched pages stay mapped and
+ * are reused by the next allocations.
+ */
+void resetArena(Arena* arena) {
+    arena->used = 0;
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Rounds size up to a power-of-two alignment
+ */
+static size_t alignSize(size_t size, size_t alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
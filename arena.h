@@ -0,0 +1,45 @@
+/**
+ * @brief Implements a bump allocator for simulation arrays
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_ALIGNMENT 64 // Cache line
+
+/**
+ * @brief Pages backing an arena
+ */
+typedef enum {
+    ARENA_PAGES_REGULAR,
+    ARENA_PAGES_TRANSPARENT, // Transparent huge pages requested with madvise
+    ARENA_PAGES_EXPLICIT     // Reserved huge pages (MAP_HUGETLB)
+} ArenaPages;
+
+/**
+ * @brief Contiguous block carved by bumping an offset. Individual
+ * allocations are never freed: the whole arena is reset or rewound.
+ */
+struct Arena {
+    unsigned char* base;
+    size_t capacity;   // Reserved bytes
+    size_t used;       // Bytes handed out (including alignment padding)
+    size_t peak;       // Largest used value since construction
+    ArenaPages pages;  // What the system granted
+};
+
+Arena* constructArena(size_t capacity, bool hugePages);
+void destroyArena(Arena* arena);
+void* allocateArena(Arena* arena, size_t size);
+
+// Scratch: rewinding to a mark releases everything allocated after it
+size_t markArena(const Arena* arena);
+void rewindArena(Arena* arena, size_t mark);
+void resetArena(Arena* arena);
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * @brief Implements simulation resets built on a background thread
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * The new simulation is allocated and filled on its own thread while the
+ * current one keeps stepping and rendering. Once built it is swapped into
+ * the current OrbitalSim in O(1) on the caller's thread, so every pointer
+ * to the simulation stays valid.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+#include "asyncReset.h"
+
+/**
+ * @brief Reset in progress
+ */
+struct AsyncReset {
+    std::thread thread;
+    float timeStep;
+    SimConfig config;
+    std::atomic<float> progress;
+    std::atomic<bool> ready;
+    OrbitalSim* result;     // NULL if building failed (valid once ready)
+};
+
+static void buildSimulation(AsyncReset* reset);
+static void reportProgress(void* context, float fraction);
+
+/**
+ * @brief Starts building a simulation with the given configuration and the
+ * time step of sim
+ */
+AsyncReset* startAsyncReset(const OrbitalSim* sim, const SimConfig* config) {
+    AsyncReset* reset = new AsyncReset();
+    reset->timeStep = sim->timeStep;
+    reset->config = *config;
+    reset->progress.store(0.0f);
+    reset->ready.store(false);
+    reset->result = NULL;
+    reset->thread = std::thread(buildSimulation, reset);
+    return reset;
+}
+
+/**
+ * @brief Fraction built so far, in [0, 1]
+ */
+float getAsyncResetProgress(const AsyncReset* reset) {
+    return reset->progress.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Has the build finished (successfully or not)?
+ */
+bool isAsyncResetReady(const AsyncReset* reset) {
+    return reset->ready.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Waits for the build and swaps it into sim. Returns false, leaving
+ * sim untouched, if the new simulation could not be built. Always destroys
+ * the reset.
+ */
+bool finishAsyncReset(AsyncReset* reset, OrbitalSim* sim) {
+    reset->thread.join();
+
+    bool built = reset->result != NULL;
+    if (built) {
+        replaceOrbitalSim(sim, reset->result);
+    }
+    else {
+        printf("Reset: keeping the current simulation\n");
+    }
+
+    delete reset;
+    return built;
+}
+
+/**
+ * @brief Waits for the build and discards it
+ */
+void cancelAsyncReset(AsyncReset* reset) {
+    if (!reset) return;
+
+    reset->thread.join();
+    destroyOrbitalSim(reset->result);
+    delete reset;
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Reset thread
+ */
+static void buildSimulation(AsyncReset* reset) {
+    reset->result = buildOrbitalSim(reset->timeStep, &reset->config, reportProgress, reset);
+    reset->ready.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Progress callback of buildOrbitalSim
+ */
+static void reportProgress(void* context, float fraction) {
+    AsyncReset* reset = (AsyncReset*)context;
+    reset->progress.store(fraction, std::memory_order_relaxed);
+}
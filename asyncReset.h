@@ -0,0 +1,21 @@
+/**
+ * @brief Implements simulation resets built on a background thread
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef ASYNCRESET_H
+#define ASYNCRESET_H
+
+#include "orbitalSim.h"
+
+struct AsyncReset;
+
+AsyncReset* startAsyncReset(const OrbitalSim* sim, const SimConfig* config);
+float getAsyncResetProgress(const AsyncReset* reset);
+bool isAsyncResetReady(const AsyncReset* reset);
+bool finishAsyncReset(AsyncReset* reset, OrbitalSim* sim);
+void cancelAsyncReset(AsyncReset* reset);
+
+#endif
@@ -0,0 +1,223 @@
+/**
+ * @brief Implements collision detection between bodies with sort-and-sweep
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * Broad phase: the box swept by each body during the step is projected on
+ * x and the bodies are kept sorted by its low bound, so only neighbours
+ * whose intervals overlap are paired. Narrow phase: both bodies move in a
+ * straight line from their start position (semi-implicit Euler moves them
+ * exactly so) and the earliest contact of the two spheres is solved for.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "collisions.h"
+#include "orbitalSim.h"
+
+#define SWEEP_MAX_SHIFTS 32 // Insertion sort shifts per body before a full re-sort
+
+/**
+ * @brief Box swept by a body during the step, expanded by its radius
+ */
+struct SweepBox {
+    float min[3];
+    float max[3];
+};
+
+static bool isSwept(const OrbitalBody* body);
+static void getSweptBox(const OrbitalSim* sim, int index, SweepBox* box);
+static void sortSweepEntries(SweepIndex* index);
+static int compareSweepEntries(const void* a, const void* b);
+static bool GetContactTime(const OrbitalSim* sim, int a, int b, float* time);
+
+/**
+ * @brief Starts an index over count bodies with unsorted entries (entries
+ * may be NULL: no collisions)
+ */
+void initializeSweepIndex(SweepIndex* index, SweepEntry* entries, int count) {
+    index->entries = entries;
+    index->count = entries ? count : 0;
+    index->sorted = false;
+    for (int i = 0; i < index->count; i++) {
+        entries[i].key = INFINITY;
+        entries[i].body = i;
+    }
+}
+
+/**
+ * @brief Bytes of the index and of its per-step scratch for count bodies
+ */
+size_t getCollisionBytes(int count) {
+    return (sizeof(SweepEntry) + 2 * sizeof(SweepBox)) * (size_t)count + sizeof(Collision) * MAX_COLLISIONS;
+}
+
+/**
+ * @brief Finds the pairs of bodies that touched during the last step (at
+ * least one of them an asteroid). Returns how many were written, at most
+ * capacity. Box scratch comes from the arena: the caller rewinds it.
+ */
+int findCollisions(OrbitalSim* sim, Collision* collisions, int capacity) {
+    SweepIndex* index = &sim->sweep;
+    if (!index->entries) return 0;
+
+    // Boxes in body order (bodies are read sequentially)
+    SweepBox* bodyBoxes = (SweepBox*)allocateArena(sim->arena, sizeof(SweepBox) * index->count);
+    SweepBox* boxes = (SweepBox*)allocateArena(sim->arena, sizeof(SweepBox) * index->count);
+    if (!bodyBoxes || !boxes) return 0;
+    for (int i = 0; i < index->count; i++) {
+        if (isSwept(&sim->bodies[i])) getSweptBox(sim, i, &bodyBoxes[i]);
+        else bodyBoxes[i].min[0] = INFINITY; // Sorted past the swept bodies
+    }
+
+    SweepEntry* entries = index->entries;
+    for (int k = 0; k < index->count; k++) {
+        entries[k].key = bodyBoxes[entries[k].body].min[0];
+    }
+    sortSweepEntries(index);
+
+    // Boxes in sweep order, so neighbours are read sequentially
+    int swept = 0;
+    while (swept < index->count && entries[swept].key < INFINITY) {
+        boxes[swept] = bodyBoxes[entries[swept].body];
+        swept++;
+    }
+
+    int found = 0;
+    for (int k = 0; k < swept; k++) {
+        const SweepBox* box = &boxes[k];
+        int a = entries[k].body;
+
+        for (int m = k + 1; m < swept && boxes[m].min[0] <= box->max[0]; m++) {
+            const SweepBox* other = &boxes[m];
+            if (other->min[1] > box->max[1] || other->max[1] < box->min[1] ||
+                other->min[2] > box->max[2] || other->max[2] < box->min[2]) continue;
+
+            int b = entries[m].body;
+            if (a < sim->systemBodies && b < sim->systemBodies) continue; // Planets and stars never merge
+
+            float time;
+            if (!GetContactTime(sim, a, b, &time)) continue;
+            if (found == capacity) return found;
+            collisions[found].first = (a < b) ? a : b;
+            collisions[found].second = (a < b) ? b : a;
+            collisions[found].time = time;
+            found++;
+        }
+    }
+    return found;
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Bodies moved by the integrator this step (drift bodies jump
+ * several steps along a curve and are left out)
+ */
+static bool isSwept(const OrbitalBody* body) {
+    return body->isAlive && body->tier == BODY_TIER_FULL;
+}
+
+/**
+ * @brief Box between the start and end positions of a body, expanded by
+ * its radius. The start position is recovered from the end velocity.
+ */
+static void getSweptBox(const OrbitalSim* sim, int index, SweepBox* box) {
+    const OrbitalBody* body = &sim->bodies[index];
+    float radius = sim->metadata[index].radius;
+    float dt = sim->timeStep;
+
+    float end[3] = { body->position.x, body->position.y, body->position.z };
+    float start[3] = {
+        end[0] - body->velocity.x * dt,
+        end[1] - body->velocity.y * dt,
+        end[2] - body->velocity.z * dt
+    };
+    for (int axis = 0; axis < 3; axis++) {
+        bool forward = start[axis] < end[axis];
+        box->min[axis] = (forward ? start[axis] : end[axis]) - radius;
+        box->max[axis] = (forward ? end[axis] : start[axis]) + radius;
+    }
+}
+
+/**
+ * @brief Restores the order by key. Insertion sort is nearly linear on the
+ * order of the previous step; a full sort is used the first time and when
+ * too many bodies changed places.
+ */
+static void sortSweepEntries(SweepIndex* index) {
+    SweepEntry* entries = index->entries;
+
+    if (index->sorted) {
+        long long budget = (long long)SWEEP_MAX_SHIFTS * index->count;
+        for (int k = 1; k < index->count && budget >= 0; k++) {
+            SweepEntry entry = entries[k];
+            int m = k - 1;
+            while (m >= 0 && entries[m].key > entry.key) {
+                entries[m + 1] = entries[m];
+                m--;
+            }
+            entries[m + 1] = entry;
+            budget -= k - 1 - m;
+        }
+        if (budget >= 0) return;
+    }
+
+    qsort(entries, index->count, sizeof(SweepEntry), compareSweepEntries);
+    index->sorted = true;
+}
+
+/**
+ * @brief qsort order of sweep entries: key, then body index
+ */
+static int compareSweepEntries(const void* a, const void* b) {
+    const SweepEntry* first = (const SweepEntry*)a;
+    const SweepEntry* second = (const SweepEntry*)b;
+    if (first->key != second->key) return (first->key < second->key) ? -1 : 1;
+    return first->body - second->body;
+}
+
+/**
+ * @brief Earliest fraction of the step at which the spheres of bodies a and
+ * b touch, each moving in a straight line. Solves |s + w t| = ra + rb with s
+ * the start separation and w the relative displacement, in double: the
+ * separations are tiny next to the coordinates.
+ */
+static bool GetContactTime(const OrbitalSim* sim, int a, int b, float* time) {
+    const OrbitalBody* first = &sim->bodies[a];
+    const OrbitalBody* second = &sim->bodies[b];
+    double dt = sim->timeStep;
+    double radius = (double)sim->metadata[a].radius + sim->metadata[b].radius;
+
+    double w[3] = {
+        ((double)first->velocity.x - second->velocity.x) * dt,
+        ((double)first->velocity.y - second->velocity.y) * dt,
+        ((double)first->velocity.z - second->velocity.z) * dt
+    };
+    double s[3] = {
+        (double)first->position.x - second->position.x - w[0],
+        (double)first->position.y - second->position.y - w[1],
+        (double)first->position.z - second->position.z - w[2]
+    };
+
+    double c = s[0] * s[0] + s[1] * s[1] + s[2] * s[2] - radius * radius;
+    if (c <= 0.0) {
+        *time = 0.0f; // Already touching at the start of the step
+        return true;
+    }
+
+    double quadratic = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+    double linear = 2.0 * (s[0] * w[0] + s[1] * w[1] + s[2] * w[2]);
+    if (quadratic == 0.0 || linear >= 0.0) return false; // Not approaching
+
+    double discriminant = linear * linear - 4.0 * quadratic * c;
+    if (discriminant < 0.0) return false; // Closest approach outside the spheres
+
+    double t = (-linear - sqrt(discriminant)) / (2.0 * quadratic);
+    if (t > 1.0) return false;
+
+    *time = (float)t;
+    return true;
+}
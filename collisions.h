@@ -0,0 +1,48 @@
+/**
+ * @brief Implements collision detection between bodies with sort-and-sweep
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef COLLISIONS_H
+#define COLLISIONS_H
+
+#include <stddef.h>
+
+#define MAX_COLLISIONS 4096 // Per step; the rest are found again next step if they still overlap
+
+struct OrbitalSim;
+
+/**
+ * @brief Body in the sweep order, keyed by the low x bound of its swept box
+ */
+struct SweepEntry {
+    float key;
+    int body;
+};
+
+/**
+ * @brief Bodies kept sorted along x between steps. Bodies barely move
+ * relative to their neighbours in one step, so re-sorting is nearly linear.
+ */
+struct SweepIndex {
+    SweepEntry* entries; // One per body (carved from arena), NULL without collisions
+    int count;
+    bool sorted;         // False until the first full sort
+};
+
+/**
+ * @brief Two bodies touching during the last step
+ */
+struct Collision {
+    int first;           // Lower body index
+    int second;
+    float time;          // Fraction of the step at contact, 0 if already touching
+};
+
+void initializeSweepIndex(SweepIndex* index, SweepEntry* entries, int count);
+size_t getCollisionBytes(int count);
+int findCollisions(OrbitalSim* sim, Collision* collisions, int capacity);
+
+#endif
@@ -0,0 +1,931 @@
+/**
+ * @brief Implements asteroid domain decomposition across worker processes
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "distributed.h"
+#include "metrics.h"
+#include "numa.h"
+#include "raymath.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define DISTRIBUTED_TIMEOUT_SECONDS 15 // A worker silent this long is lost (steps take milliseconds)
+#define DISTRIBUTED_MAGIC 0x5752424F // "OBRW"
+#define DISTRIBUTED_VERSION 1
+#define DISTRIBUTED_DEFAULT_ADDRESS "127.0.0.1" // Workers only listen on loopback unless told otherwise
+
+/**
+ * @brief Message types. Every request gets a reply with the same type.
+ */
+typedef enum {
+    MESSAGE_INIT,      // Handshake, configuration and owned bodies -> handshake
+    MESSAGE_FORCES,    // System bodies + black hole -> black hole pull of the slice
+    MESSAGE_ADVANCE,   // Moved black hole -> accreted mass, count and fate events
+    MESSAGE_GATHER,    // -> current state of the owned asteroids
+    MESSAGE_ROLLBACK,  // -> owned asteroids as sent by the last gather before the last step
+    MESSAGE_SHUTDOWN
+} MessageType;
+
+struct MessageHeader {
+    uint32_t type;
+    uint32_t size;     // Payload bytes following the header
+};
+
+/**
+ * @brief Starts the INIT request and its reply. Structures travel as raw
+ * bytes, so both builds must agree on their layout, not only on the version.
+ */
+struct Handshake {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t layout;   // getLayoutFingerprint() of the sender
+};
+
+struct InitMessage {    // Follows the Handshake
+    float timeStep;
+    SimConfig config;
+    int systemBodies;
+    int count;         // Owned asteroids; bodies[systemBodies + count] follow
+    double time;
+};
+
+struct AdvanceReply {
+    double mass;
+    int count;
+    int events;        // FateEvent records follow (worker body indices)
+};
+
+/**
+ * @brief Worker process state: system bodies followed by the owned slice
+ */
+struct WorkerState {
+    OrbitalSim* sim;
+    Vector3* accelerations;
+    OrbitalBody* checkpoint; // Owned asteroids at the last gather the coordinator stepped from
+    bool gathered;           // Gathered since the last step: checkpoint is due
+};
+
+static bool sendAll(int fd, const void* data, size_t size);
+static bool recvAll(int fd, void* data, size_t size);
+static bool sendMessage(int fd, MessageType type, const void* payload, size_t size, const void* extra, size_t extraSize);
+static bool recvMessage(int fd, MessageType expected, void* payload, size_t size);
+static bool recvHeader(int fd, MessageType expected, uint32_t* size);
+static bool scatterBodies(DistributedSim* dist);
+static bool stepDistributedSim(DistributedSim* dist, Vector3* accelerations);
+static void restoreCheckpoint(DistributedSim* dist);
+static bool loseWorker(DistributedSim* dist, int index);
+static DistributedSim* allocateDistributedSim(OrbitalSim* sim);
+static int connectEndpoint(const char* endpoint);
+static void configureSocket(int fd);
+static void setSocketTimeout(int fd, int seconds);
+static Handshake getHandshake(void);
+static uint64_t getLayoutFingerprint(void);
+static bool isSameBuild(const Handshake* a, const Handshake* b);
+static int listenEndpoint(const char* endpoint);
+static void runWorkerLoop(int fd, bool* initialized);
+static bool handleInit(WorkerState* worker, int fd, uint32_t size);
+static bool isValidInit(const InitMessage* init, uint32_t size);
+static bool handleForces(WorkerState* worker, int fd, uint32_t size);
+static bool handleAdvance(WorkerState* worker, int fd, uint32_t size);
+static bool handleGather(WorkerState* worker, int fd);
+static bool handleRollback(WorkerState* worker, int fd);
+
+/**
+ * @brief Starts local worker processes and hands each a slice of asteroids
+ */
+DistributedSim* constructDistributedSim(OrbitalSim* sim, int localWorkers, bool numa) {
+    if (!sim || localWorkers < 1) return NULL;
+    if (localWorkers > DISTRIBUTED_MAX_WORKERS) localWorkers = DISTRIBUTED_MAX_WORKERS;
+
+    DistributedSim* dist = allocateDistributedSim(sim);
+    if (!dist) return NULL;
+
+    int nodes = numa ? getNumaNodeCount() : 1;
+
+    for (int w = 0; w < localWorkers; w++) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            perror("socketpair");
+            destroyDistributedSim(dist);
+            return NULL;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            close(fds[0]);
+            close(fds[1]);
+            destroyDistributedSim(dist);
+            return NULL;
+        }
+
+        if (pid == 0) {
+            // Worker: drop the coordinator ends inherited so far
+            for (int i = 0; i < dist->numWorkers; i++) {
+                close(dist->workers[i].fd);
+            }
+            close(fds[0]);
+
+            // Pinned before building its simulation: the slice is first
+            // touched on the worker node
+            if (nodes > 1) {
+                bindToNumaNode(w % nodes);
+            }
+            bool initialized;
+            runWorkerLoop(fds[1], &initialized);
+            _exit(0);
+        }
+
+        close(fds[1]);
+        setSocketTimeout(fds[0], DISTRIBUTED_TIMEOUT_SECONDS);
+        DistributedWorker* worker = &dist->workers[dist->numWorkers++];
+        worker->fd = fds[0];
+        worker->pid = (int)pid;
+    }
+
+    if (!scatterBodies(dist)) {
+        destroyDistributedSim(dist);
+        return NULL;
+    }
+
+    return dist;
+}
+
+/**
+ * @brief Connects to remote workers listed as "host:port,host:port,..."
+ */
+DistributedSim* connectDistributedSim(OrbitalSim* sim, const char* endpoints) {
+    if (!sim || !endpoints) return NULL;
+
+    DistributedSim* dist = allocateDistributedSim(sim);
+    if (!dist) return NULL;
+
+    char list[1024];
+    snprintf(list, sizeof(list), "%s", endpoints);
+
+    for (char* endpoint = strtok(list, ","); endpoint; endpoint = strtok(NULL, ",")) {
+        if (dist->numWorkers >= DISTRIBUTED_MAX_WORKERS) break;
+
+        int fd = connectEndpoint(endpoint);
+        if (fd < 0) {
+            printf("Distributed: cannot connect to worker %s\n", endpoint);
+            destroyDistributedSim(dist);
+            return NULL;
+        }
+
+        DistributedWorker* worker = &dist->workers[dist->numWorkers++];
+        worker->fd = fd;
+        worker->pid = 0;
+    }
+
+    if (dist->numWorkers == 0 || !scatterBodies(dist)) {
+        destroyDistributedSim(dist);
+        return NULL;
+    }
+
+    return dist;
+}
+
+/**
+ * @brief Stops the workers. Asteroid state is only kept up to the last sync.
+ */
+void destroyDistributedSim(DistributedSim* dist) {
+    if (!dist) return;
+
+    destroyOrbitalSim(dist->checkpoint);
+
+    for (int w = 0; w < dist->numWorkers; w++) {
+        DistributedWorker* worker = &dist->workers[w];
+        bool lost = w == dist->lostWorker; // May be stalled rather than gone
+        if (!lost) sendMessage(worker->fd, MESSAGE_SHUTDOWN, NULL, 0, NULL, 0);
+        close(worker->fd);
+        if (worker->pid > 0) {
+            if (lost) kill((pid_t)worker->pid, SIGKILL);
+            waitpid((pid_t)worker->pid, NULL, 0);
+        }
+    }
+
+    free(dist);
+}
+
+/**
+ * @brief Simulates a timestep with the asteroids owned by the workers
+ *
+ * Per step only the system bodies and the black hole are broadcast, and the
+ * workers send back the black hole pull of their slice and what it swallowed.
+ *
+ * Returns false if a worker fails. The simulation is then back at the last
+ * scatter or sync, with every body at the same time, and can go on in this
+ * process (after a failed scatter it is the freshly reset one).
+ */
+bool updateDistributedSim(DistributedSim* dist) {
+    OrbitalSim* sim = dist->sim;
+
+    if (sim->generation != dist->generation && !scatterBodies(dist)) return false;
+
+    bool stepped = stepDistributedSim(dist, sim->accelerations);
+    if (!stepped) restoreCheckpoint(dist);
+    return stepped;
+}
+
+/**
+ * @brief Copies the asteroid slices back into sim->bodies (e.g. once per
+ * frame) and checkpoints the rest of the state. Returns false if a worker
+ * fails, with the simulation back at the previous checkpoint: the slices
+ * already gathered are asked back as they were then. If the failing worker
+ * had sent part of its slice, that slice is gone and stateLost is set.
+ */
+bool syncDistributedSim(DistributedSim* dist) {
+    OrbitalSim* sim = dist->sim;
+    if (sim->generation != dist->generation) return true; // Not scattered yet
+
+    int requested = 0;
+    while (requested < dist->numWorkers &&
+        sendMessage(dist->workers[requested].fd, MESSAGE_GATHER, NULL, 0, NULL, 0)) requested++;
+
+    int gathered = 0;
+    while (gathered < requested) {
+        DistributedWorker* worker = &dist->workers[gathered];
+        size_t size = sizeof(OrbitalBody) * (worker->end - worker->begin);
+        uint32_t received;
+        if (!recvHeader(worker->fd, MESSAGE_GATHER, &received) || received != size) break;
+        if (!recvAll(worker->fd, &sim->bodies[worker->begin], size)) {
+            dist->stateLost = true;
+            break;
+        }
+        gathered++;
+    }
+    if (gathered < dist->numWorkers) loseWorker(dist, gathered); // The first that did not answer
+
+    if (gathered == dist->numWorkers) {
+        copyOrbitalSystemState(dist->checkpoint, sim);
+        dist->checkpointEvents = sim->fateEventCount;
+        return true;
+    }
+
+    for (int w = 0; w < gathered && !dist->stateLost; w++) {
+        DistributedWorker* worker = &dist->workers[w];
+        dist->stateLost = !sendMessage(worker->fd, MESSAGE_ROLLBACK, NULL, 0, NULL, 0) ||
+            !recvMessage(worker->fd, MESSAGE_ROLLBACK, &sim->bodies[worker->begin],
+                sizeof(OrbitalBody) * (worker->end - worker->begin));
+    }
+    restoreCheckpoint(dist);
+    return false;
+}
+
+/**
+ * @brief Serves a single coordinator on "[address:]port" (loopback if no
+ * address is given). Peers that do not complete a valid INIT in time are
+ * dropped and the next one is accepted.
+ */
+int runDistributedWorker(const char* endpoint) {
+    int listener = listenEndpoint(endpoint);
+    if (listener < 0) {
+        printf("Distributed worker: cannot listen on %s\n", endpoint);
+        return 1;
+    }
+
+    for (;;) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            close(listener);
+            return 1;
+        }
+
+        // Bounded until the INIT, then blocking: the coordinator may pause
+        configureSocket(fd);
+        setSocketTimeout(fd, DISTRIBUTED_TIMEOUT_SECONDS);
+        bool initialized;
+        runWorkerLoop(fd, &initialized);
+        close(fd);
+        if (initialized) break;
+        printf("Distributed worker: peer dropped before a valid INIT, waiting for another\n");
+    }
+
+    close(listener);
+    return 0;
+}
+
+//***** COORDINATOR HELPERS *****//
+
+/**
+ * @brief Allocates an empty coordinator
+ */
+static DistributedSim* allocateDistributedSim(OrbitalSim* sim) {
+    DistributedSim* dist = (DistributedSim*)calloc(1, sizeof(DistributedSim));
+    if (!dist) return NULL;
+
+    dist->sim = sim;
+    dist->generation = sim->generation - 1;
+    dist->lostWorker = -1;
+    return dist;
+}
+
+/**
+ * @brief Splits the asteroids in contiguous slices and sends one to each
+ * worker. The state sent becomes the checkpoint.
+ */
+static bool scatterBodies(DistributedSim* dist) {
+    OrbitalSim* sim = dist->sim;
+
+    // Built for the current configuration (a reset may change the system)
+    destroyOrbitalSim(dist->checkpoint);
+    dist->checkpoint = cloneOrbitalSystem(sim);
+    if (!dist->checkpoint) return false;
+    dist->checkpointEvents = sim->fateEventCount;
+
+    int systemBodies = sim->systemBodies;
+    int asteroids = sim->numBodies - systemBodies;
+    int perWorker = asteroids / dist->numWorkers;
+    int remainder = asteroids % dist->numWorkers;
+
+    int begin = systemBodies;
+    for (int w = 0; w < dist->numWorkers; w++) {
+        DistributedWorker* worker = &dist->workers[w];
+        worker->begin = begin;
+        worker->end = begin + perWorker + (w < remainder ? 1 : 0);
+        begin = worker->end;
+
+        InitMessage init;
+        init.timeStep = sim->timeStep;
+        init.config = sim->config;
+        init.systemBodies = systemBodies;
+        init.count = worker->end - worker->begin;
+        init.time = sim->time;
+
+        // Payload: handshake, init, system bodies, owned slice
+        Handshake handshake = getHandshake();
+        size_t size = sizeof(Handshake) + sizeof(InitMessage) + sizeof(OrbitalBody) * (systemBodies + init.count);
+        MessageHeader header = { MESSAGE_INIT, (uint32_t)size };
+        if (!sendAll(worker->fd, &header, sizeof(header)) ||
+            !sendAll(worker->fd, &handshake, sizeof(handshake)) ||
+            !sendAll(worker->fd, &init, sizeof(init)) ||
+            !sendAll(worker->fd, sim->bodies, sizeof(OrbitalBody) * systemBodies) ||
+            !sendAll(worker->fd, &sim->bodies[worker->begin], sizeof(OrbitalBody) * init.count)) return loseWorker(dist, w);
+    }
+
+    Handshake own = getHandshake();
+    for (int w = 0; w < dist->numWorkers; w++) {
+        Handshake handshake;
+        if (!recvMessage(dist->workers[w].fd, MESSAGE_INIT, &handshake, sizeof(handshake))) return loseWorker(dist, w);
+        if (!isSameBuild(&handshake, &own)) {
+            printf("Distributed: worker %d runs another build (version %u, layout %016llx; here %u, %016llx)\n",
+                w, handshake.version, (unsigned long long)handshake.layout, own.version, (unsigned long long)own.layout);
+            return loseWorker(dist, w);
+        }
+    }
+
+    dist->generation = sim->generation;
+    return true;
+}
+
+/**
+ * @brief Puts the simulation back at the last checkpoint. The asteroids in
+ * sim->bodies are the last ones gathered (steps only move them on the
+ * workers), so the system bodies, the black hole, moons, rings and fate
+ * events are brought back to that same time. The steps up to the failure
+ * are simulated again without reporting them twice.
+ */
+static void restoreCheckpoint(DistributedSim* dist) {
+    OrbitalSim* sim = dist->sim;
+    if (!dist->checkpoint || dist->checkpoint->generation != sim->generation) return;
+
+    double lost = sim->time - dist->checkpoint->time;
+    if (sim->time > sim->replayedTime) sim->replayedTime = sim->time; // Reported up to here
+    copyOrbitalSystemState(sim, dist->checkpoint);
+    sim->fateEventCount = dist->checkpointEvents;
+    sim->stepEventBegin = dist->checkpointEvents;
+    printf("Distributed: back to the last synchronized state (%.0f simulated seconds earlier)\n", lost);
+}
+
+/**
+ * @brief Records the first worker that failed. Always returns false.
+ */
+static bool loseWorker(DistributedSim* dist, int index) {
+    if (dist->lostWorker < 0) dist->lostWorker = index;
+    return false;
+}
+
+/**
+ * @brief One distributed timestep with the given scratch for system bodies
+ */
+static bool stepDistributedSim(DistributedSim* dist, Vector3* accelerations) {
+    OrbitalSim* sim = dist->sim;
+    int systemBodies = sim->systemBodies;
+
+    // Forces: system bodies locally, asteroid slices remotely
+    computeSystemAccelerations(sim, accelerations);
+
+    for (int w = 0; w < dist->numWorkers; w++) {
+        if (!sendMessage(dist->workers[w].fd, MESSAGE_FORCES, &sim->blackHole, sizeof(BlackHole),
+            sim->bodies, sizeof(OrbitalBody) * systemBodies)) return loseWorker(dist, w);
+    }
+
+    for (int w = 0; w < dist->numWorkers; w++) {
+        Vector3 pull;
+        if (!recvMessage(dist->workers[w].fd, MESSAGE_FORCES, &pull, sizeof(pull))) return loseWorker(dist, w);
+        if (sim->blackHole.isActive) {
+            sim->blackHole.acceleration = Vector3Add(sim->blackHole.acceleration, pull);
+        }
+    }
+
+    advanceBlackHole(sim);
+
+    // Advance: system bodies first (serial order), then the slices
+    sim->stepEventBegin = sim->fateEventCount;
+    int accreted = advanceBodyRange(sim, accelerations, 0, systemBodies);
+
+    for (int w = 0; w < dist->numWorkers; w++) {
+        if (!sendMessage(dist->workers[w].fd, MESSAGE_ADVANCE, &sim->blackHole, sizeof(BlackHole), NULL, 0)) return loseWorker(dist, w);
+    }
+
+    for (int w = 0; w < dist->numWorkers; w++) {
+        DistributedWorker* worker = &dist->workers[w];
+        AdvanceReply reply;
+        uint32_t size;
+        if (!recvHeader(worker->fd, MESSAGE_ADVANCE, &size) || size < sizeof(reply) ||
+            !recvAll(worker->fd, &reply, sizeof(reply)) ||
+            size != sizeof(reply) + sizeof(FateEvent) * reply.events) return loseWorker(dist, w);
+
+        accreteIntoBlackHole(sim, reply.mass, reply.count);
+        accreted += reply.count;
+
+        // Worker events use its own layout (system bodies, then its slice).
+        // Their black hole mass only includes the accretions of that slice.
+        for (int e = 0; e < reply.events; e++) {
+            FateEvent event;
+            if (!recvAll(worker->fd, &event, sizeof(event))) return loseWorker(dist, w);
+            event.body += worker->begin - systemBodies;
+            recordFateEvent(sim, &event);
+        }
+    }
+
+    sim->aliveBodies -= accreted;
+    sim->time += sim->timeStep;
+
+    addMetric(METRIC_ACCRETIONS, accreted);
+    addMetric(METRIC_STEPS, 1);
+    addMetric(METRIC_SIMULATED_SECONDS, sim->timeStep);
+    return true;
+}
+
+/**
+ * @brief Opens a TCP connection to "host:port"
+ */
+static int connectEndpoint(const char* endpoint) {
+    char host[256];
+    snprintf(host, sizeof(host), "%s", endpoint);
+
+    char* separator = strrchr(host, ':');
+    if (!separator) return -1;
+    *separator = '\0';
+    const char* port = separator + 1;
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* result = NULL;
+    if (getaddrinfo(host, port, &hints, &result) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo* ai = result; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+
+    if (fd >= 0) {
+        configureSocket(fd);
+        setSocketTimeout(fd, DISTRIBUTED_TIMEOUT_SECONDS);
+    }
+    return fd;
+}
+
+/**
+ * @brief Opens a listening TCP socket on "[address:]port"
+ */
+static int listenEndpoint(const char* endpoint) {
+    char host[256];
+    const char* separator = strrchr(endpoint, ':');
+    const char* port = separator ? separator + 1 : endpoint;
+    snprintf(host, sizeof(host), "%.*s", separator ? (int)(separator - endpoint) : 0, endpoint);
+    if (!host[0]) snprintf(host, sizeof(host), "%s", DISTRIBUTED_DEFAULT_ADDRESS);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo* result = NULL;
+    if (getaddrinfo(host, port, &hints, &result) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo* ai = result; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) != 0 || listen(fd, 1) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+
+    if (fd >= 0) printf("Distributed worker listening on %s:%s\n", host, port);
+    return fd;
+}
+
+/**
+ * @brief Small messages every step: disable Nagle and SIGPIPE
+ */
+static void configureSocket(int fd) {
+    int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+#ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+}
+
+/**
+ * @brief Bounds how long a send or receive may block (0: forever), so a
+ * stalled peer fails like a closed one
+ */
+static void setSocketTimeout(int fd, int seconds) {
+    struct timeval timeout;
+    timeout.tv_sec = seconds;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+//***** WORKER *****//
+
+/**
+ * @brief Serves coordinator requests until shutdown or disconnection.
+ * Tells whether an INIT was accepted.
+ */
+static void runWorkerLoop(int fd, bool* initialized) {
+    WorkerState worker;
+    memset(&worker, 0, sizeof(worker));
+    *initialized = false;
+
+    bool running = true;
+    while (running) {
+        MessageHeader header;
+        if (!recvAll(fd, &header, sizeof(header))) break;
+
+        switch (header.type) {
+        case MESSAGE_INIT:
+            running = handleInit(&worker, fd, header.size);
+            if (running && !*initialized) {
+                *initialized = true;
+                setSocketTimeout(fd, 0);
+            }
+            break;
+        case MESSAGE_FORCES:  running = handleForces(&worker, fd, header.size); break;
+        case MESSAGE_ADVANCE: running = handleAdvance(&worker, fd, header.size); break;
+        case MESSAGE_GATHER:  running = handleGather(&worker, fd); break;
+        case MESSAGE_ROLLBACK: running = handleRollback(&worker, fd); break;
+        default:              running = false; break;
+        }
+    }
+
+    free(worker.checkpoint);
+    destroyOrbitalSim(worker.sim);
+}
+
+/**
+ * @brief Rebuilds the local simulation with the received bodies
+ */
+static bool handleInit(WorkerState* worker, int fd, uint32_t size) {
+    // Nothing else is read from a peer of another build
+    Handshake own = getHandshake();
+    Handshake handshake;
+    if (size < sizeof(handshake) || !recvAll(fd, &handshake, sizeof(handshake))) return false;
+    if (!isSameBuild(&handshake, &own)) {
+        printf("Distributed worker: coordinator of another build (version %u, layout %016llx), closing\n",
+            handshake.version, (unsigned long long)handshake.layout);
+        sendMessage(fd, MESSAGE_INIT, &own, sizeof(own), NULL, 0);
+        return false;
+    }
+
+    InitMessage init;
+    if (size < sizeof(handshake) + sizeof(init) || !recvAll(fd, &init, sizeof(init))) return false;
+    if (!isValidInit(&init, size)) {
+        printf("Distributed worker: invalid INIT, closing\n");
+        return false;
+    }
+
+    SimConfig config = init.config;
+    config.asteroidCount = init.count;
+    config.driftSteps = 1; // Slots depend on the global index and the star history
+    config.ringParticles = 0; // Rings stay on the coordinator
+    config.collisions = false; // Pairs may span slices
+    config.encounterHillRadii = 0.0f;
+    config.hybrid = false; // Needs the star advanced before the asteroids
+    config.frame = FRAME_EPHEMERIS; // The star acceleration stays on the coordinator
+
+    if (!worker->sim) {
+        worker->sim = constructOrbitalSim(init.timeStep, &config);
+    }
+    else if (!resetOrbitalSim(worker->sim, &config)) {
+        return false;
+    }
+
+    OrbitalSim* sim = worker->sim;
+    int numBodies = init.systemBodies + init.count;
+    if (!sim || sim->numBodies != numBodies) return false;
+
+    if (!recvAll(fd, sim->bodies, sizeof(OrbitalBody) * numBodies)) return false;
+    sim->time = init.time;
+
+    // Lives in the simulation arena until the next reset
+    worker->accelerations = (Vector3*)allocateArena(sim->arena, sizeof(Vector3) * numBodies);
+    if (!worker->accelerations) return false;
+
+    OrbitalBody* checkpoint = (OrbitalBody*)realloc(worker->checkpoint, sizeof(OrbitalBody) * (init.count > 0 ? init.count : 1));
+    if (!checkpoint) return false;
+    worker->checkpoint = checkpoint;
+    memcpy(checkpoint, &sim->bodies[init.systemBodies], sizeof(OrbitalBody) * init.count);
+    worker->gathered = false;
+
+    return sendMessage(fd, MESSAGE_INIT, &own, sizeof(own), NULL, 0);
+}
+
+/**
+ * @brief Checks an INIT before anything is allocated for it: known enum
+ * values, the system body count of that system and a payload of exactly
+ * that many bodies
+ */
+static bool isValidInit(const InitMessage* init, uint32_t size) {
+    const SimConfig* config = &init->config;
+    if ((unsigned)config->systemType > SYSTEM_TYPE_ALPHA_CENTAURI ||
+        (unsigned)config->easterEgg > EASTER_EGG_JUPITER_1000X ||
+        (unsigned)config->dispersion > DISPERSION_EXTREME ||
+        (unsigned)config->isa > ISA_LEVEL_AVX512) return false;
+
+    if (init->systemBodies != getSystemBodyCount(config->systemType) || init->count < 0) return false;
+    if (!isfinite(init->timeStep) || init->timeStep <= 0.0f || !isfinite(init->time)) return false;
+
+    uint64_t expected = sizeof(Handshake) + sizeof(InitMessage) +
+        sizeof(OrbitalBody) * ((uint64_t)init->systemBodies + (uint64_t)init->count);
+    return expected == size;
+}
+
+/**
+ * @brief Computes accelerations on the owned asteroids
+ */
+static bool handleForces(WorkerState* worker, int fd, uint32_t size) {
+    OrbitalSim* sim = worker->sim;
+    if (!sim || size != sizeof(BlackHole) + sizeof(OrbitalBody) * sim->systemBodies) return false;
+
+    if (!recvAll(fd, &sim->blackHole, sizeof(BlackHole)) ||
+        !recvAll(fd, sim->bodies, sizeof(OrbitalBody) * sim->systemBodies)) return false;
+
+    // Stepping on from the last gather: it is the state to roll back to
+    int count = sim->numBodies - sim->systemBodies;
+    if (worker->gathered) {
+        memcpy(worker->checkpoint, &sim->bodies[sim->systemBodies], sizeof(OrbitalBody) * count);
+        worker->gathered = false;
+    }
+
+    sim->blackHole.acceleration = { 0.0f, 0.0f, 0.0f };
+    computeAsteroidRange(sim, worker->accelerations, sim->systemBodies, sim->numBodies);
+
+    Vector3 pull = sim->blackHole.acceleration;
+    return sendMessage(fd, MESSAGE_FORCES, &pull, sizeof(pull), NULL, 0);
+}
+
+/**
+ * @brief Accretes and integrates the owned asteroids
+ */
+static bool handleAdvance(WorkerState* worker, int fd, uint32_t size) {
+    OrbitalSim* sim = worker->sim;
+    if (!sim || size != sizeof(BlackHole) || !recvAll(fd, &sim->blackHole, sizeof(BlackHole))) return false;
+
+    double massBefore = sim->blackHole.mass;
+    sim->stepEventBegin = sim->fateEventCount;
+
+    AdvanceReply reply;
+    reply.count = advanceBodyRange(sim, worker->accelerations, sim->systemBodies, sim->numBodies);
+    reply.mass = sim->blackHole.mass - massBefore;
+    reply.events = sim->fateEventCount - sim->stepEventBegin;
+    sim->time += sim->timeStep;
+
+    return sendMessage(fd, MESSAGE_ADVANCE, &reply, sizeof(reply),
+        &sim->fateEvents[sim->stepEventBegin], sizeof(FateEvent) * reply.events);
+}
+
+/**
+ * @brief Sends the owned asteroids back to the coordinator
+ */
+static bool handleGather(WorkerState* worker, int fd) {
+    OrbitalSim* sim = worker->sim;
+    if (!sim) return false;
+
+    int count = sim->numBodies - sim->systemBodies;
+    worker->gathered = true;
+    return sendMessage(fd, MESSAGE_GATHER, &sim->bodies[sim->systemBodies], sizeof(OrbitalBody) * count, NULL, 0);
+}
+
+/**
+ * @brief Sends back the owned asteroids of the last checkpoint, after the
+ * coordinator failed to gather every slice
+ */
+static bool handleRollback(WorkerState* worker, int fd) {
+    OrbitalSim* sim = worker->sim;
+    if (!sim) return false;
+
+    int count = sim->numBodies - sim->systemBodies;
+    return sendMessage(fd, MESSAGE_ROLLBACK, worker->checkpoint, sizeof(OrbitalBody) * count, NULL, 0);
+}
+
+//***** TRANSPORT *****//
+
+/**
+ * @brief Writes a whole buffer to a stream socket
+ */
+static bool sendAll(int fd, const void* data, size_t size) {
+    const char* bytes = (const char*)data;
+    while (size > 0) {
+        ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            printf("Distributed: peer stalled (timed out sending)\n");
+        }
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a whole buffer from a stream socket
+ */
+static bool recvAll(int fd, void* data, size_t size) {
+    char* bytes = (char*)data;
+    while (size > 0) {
+        ssize_t received = recv(fd, bytes, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            printf("Distributed: peer stalled (timed out receiving)\n");
+        }
+        if (received <= 0) return false;
+        bytes += received;
+        size -= (size_t)received;
+    }
+    return true;
+}
+
+/**
+ * @brief Sends a header and a payload made of up to two parts
+ */
+static bool sendMessage(int fd, MessageType type, const void* payload, size_t size, const void* extra, size_t extraSize) {
+    MessageHeader header = { (uint32_t)type, (uint32_t)(size + extraSize) };
+    return sendAll(fd, &header, sizeof(header)) &&
+        (size == 0 || sendAll(fd, payload, size)) &&
+        (extraSize == 0 || sendAll(fd, extra, extraSize));
+}
+
+/**
+ * @brief Receives a reply of an expected type and size
+ */
+static bool recvMessage(int fd, MessageType expected, void* payload, size_t size) {
+    uint32_t received;
+    if (!recvHeader(fd, expected, &received)) return false;
+    if (received != size) {
+        printf("Distributed: unexpected reply from worker\n");
+        return false;
+    }
+    return size == 0 || recvAll(fd, payload, size);
+}
+
+/**
+ * @brief Receives the header of a variable-size reply of an expected type
+ */
+static bool recvHeader(int fd, MessageType expected, uint32_t* size) {
+    MessageHeader header;
+    if (!recvAll(fd, &header, sizeof(header))) return false;
+    if (header.type != (uint32_t)expected) {
+        printf("Distributed: unexpected reply from worker\n");
+        return false;
+    }
+    *size = header.size;
+    return true;
+}
+
+/**
+ * @brief Handshake of this build
+ */
+static Handshake getHandshake(void) {
+    Handshake handshake;
+    handshake.magic = DISTRIBUTED_MAGIC;
+    handshake.version = DISTRIBUTED_VERSION;
+    handshake.layout = getLayoutFingerprint();
+    return handshake;
+}
+
+/**
+ * @brief FNV-1a of the sizes and offsets of everything sent raw. Hashed as
+ * bytes, so the byte order and the float format count too.
+ */
+static uint64_t getLayoutFingerprint(void) {
+    const uint64_t layout[] = {
+        sizeof(MessageHeader), sizeof(Handshake), sizeof(InitMessage), sizeof(AdvanceReply),
+        offsetof(InitMessage, config), offsetof(InitMessage, systemBodies), offsetof(InitMessage, time),
+        offsetof(AdvanceReply, count), offsetof(AdvanceReply, events),
+        sizeof(Vector3), sizeof(SimConfig), offsetof(SimConfig, ringParticles), offsetof(SimConfig, isa),
+        sizeof(OrbitalBody), offsetof(OrbitalBody, velocity), offsetof(OrbitalBody, mass),
+        offsetof(OrbitalBody, isAlive), offsetof(OrbitalBody, fate), offsetof(OrbitalBody, tier),
+        sizeof(BlackHole), offsetof(BlackHole, acceleration), offsetof(BlackHole, mass),
+        offsetof(BlackHole, radius), offsetof(BlackHole, isActive),
+        sizeof(FateEvent), offsetof(FateEvent, time), offsetof(FateEvent, relativeSpeed),
+        offsetof(FateEvent, blackHoleMass), offsetof(FateEvent, target)
+    };
+    const double probe = -1.5;
+
+    uint64_t hash = 14695981039346656037ULL;
+    const unsigned char* parts[2] = { (const unsigned char*)layout, (const unsigned char*)&probe };
+    size_t sizes[2] = { sizeof(layout), sizeof(probe) };
+    for (int p = 0; p < 2; p++) {
+        for (size_t i = 0; i < sizes[p]; i++) {
+            hash = (hash ^ parts[p][i]) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+/**
+ * @brief Tells whether a peer handshake matches this build
+ */
+static bool isSameBuild(const Handshake* a, const Handshake* b) {
+    return a->magic == b->magic && a->version == b->version && a->layout == b->layout;
+}
+
+#else
+
+// Process creation and sockets are POSIX-only: run single process instead
+
+DistributedSim* constructDistributedSim(OrbitalSim* sim, int localWorkers, bool numa) {
+    printf("Distributed workers are not supported on this platform\n");
+    return NULL;
+}
+
+DistributedSim* connectDistributedSim(OrbitalSim* sim, const char* endpoints) {
+    printf("Distributed workers are not supported on this platform\n");
+    return NULL;
+}
+
+void destroyDistributedSim(DistributedSim* dist) {
+    free(dist);
+}
+
+bool updateDistributedSim(DistributedSim* dist) {
+    return false;
+}
+
+bool syncDistributedSim(DistributedSim* dist) {
+    return false;
+}
+
+int runDistributedWorker(const char* endpoint) {
+    printf("Distributed workers are not supported on this platform\n");
+    return 1;
+}
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ * @brief Implements asteroid domain decomposition across worker processes
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include "orbitalSim.h"
+
+#define DISTRIBUTED_MAX_WORKERS 64
+
+/**
+ * @brief Connection to one worker and the asteroid slice it owns
+ */
+struct DistributedWorker {
+    int fd;          // Stream socket (UNIX socketpair or TCP)
+    int pid;         // Local worker process, 0 for remote workers
+    int begin;       // First asteroid index owned (in sim->bodies)
+    int end;         // One past the last asteroid index owned
+};
+
+/**
+ * @brief Coordinator state (lives in the rendering process)
+ */
+struct DistributedSim {
+    OrbitalSim* sim;
+    OrbitalSim* checkpoint; // All but the asteroids at the last scatter or sync (those are in sim->bodies)
+    int checkpointEvents;   // sim->fateEventCount at the checkpoint
+    bool stateLost;         // A slice was lost halfway through a gather: cannot go on anywhere
+    int lostWorker;         // Index of the first worker that failed, -1 if none
+    DistributedWorker workers[DISTRIBUTED_MAX_WORKERS];
+    int numWorkers;
+    int generation;  // sim->generation the slices were scattered for
+};
+
+// Coordinator
+DistributedSim* constructDistributedSim(OrbitalSim* sim, int localWorkers, bool numa);
+DistributedSim* connectDistributedSim(OrbitalSim* sim, const char* endpoints);
+void destroyDistributedSim(DistributedSim* dist);
+bool updateDistributedSim(DistributedSim* dist);
+bool syncDistributedSim(DistributedSim* dist);
+
+// Remote worker entry point: serves one coordinator on "[address:]port"
+// (loopback by default)
+int runDistributedWorker(const char* endpoint);
+
+#endif
@@ -0,0 +1,440 @@
+/**
+ * @brief Implements close-approach tracking between asteroids and planets
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * Each asteroid waits in a priority queue keyed on the first step at which
+ * it could reach the encounter sphere (config.encounterHillRadii Hill radii)
+ * of any planet, from a bound on the closing speed. Only the asteroids that
+ * come due are checked. Inside a sphere the asteroid is checked every step:
+ * the relative motion over the step is interpolated with a cubic Hermite
+ * curve and its minimum distance is searched for.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "encounters.h"
+#include "eventLog.h"
+#include "metrics.h"
+#include "orbitalSim.h"
+#include "raymath.h"
+
+#define GRAVITATIONAL_CONSTANT 6.6743E-11
+#define ENCOUNTER_SPEED_MARGIN 2.0     // Safety factor on the closing speed bound
+#define ENCOUNTER_MAX_WAIT 256         // Most steps between two checks of an asteroid
+#define ENCOUNTER_BLACK_HOLE_WAIT 16   // Most steps between two checks while the black hole is active
+#define ENCOUNTER_SAMPLES 8            // Samples of the interpolated distance per step
+#define ENCOUNTER_REFINE_ITERATIONS 32 // Golden-section iterations around the best sample
+
+/**
+ * @brief Next check of an asteroid
+ */
+struct EncounterCheck {
+    long long step;   // Step at whose end the asteroid is checked
+    int asteroid;
+
+    bool operator>(const EncounterCheck& other) const {
+        return (step != other.step) ? step > other.step : asteroid > other.asteroid;
+    }
+};
+
+/**
+ * @brief Asteroid inside the encounter sphere of a planet
+ */
+struct Encounter {
+    int asteroid;
+    int planet;
+    double hillRadius;       // Of the planet when the encounter started [m]
+    double closestTime;      // [s]
+    double closestDistance;  // [m]
+    double closestSpeed;     // [m/s]
+};
+
+/**
+ * @brief Relative position and velocity of an asteroid to a planet, in
+ * double: the separations are tiny next to the coordinates
+ */
+struct RelativeState {
+    double r[3];
+    double v[3];
+};
+
+struct EncounterTracker {
+    std::priority_queue<EncounterCheck, std::vector<EncounterCheck>, std::greater<EncounterCheck> > schedule;
+    std::vector<Encounter> active;
+    std::vector<CloseApproach> approaches;
+    std::vector<double> sphereRadii; // Per system body, this step (0: not a planet)
+    int systemBodies;
+    int numBodies;
+    MemoryAccount memory;
+};
+
+static long long getNextCheck(const EncounterTracker* tracker, const OrbitalSim* sim, int asteroid, long long step, int* planet);
+static double getBlackHolePull(const OrbitalSim* sim, Vector3 position);
+static void finishEncounter(EncounterTracker* tracker, const Encounter* encounter);
+static void RefineClosestApproach(const OrbitalSim* sim, Encounter* encounter);
+static void GetRelativeAcceleration(const OrbitalSim* sim, int asteroid, int planet, double span, double* acceleration);
+static void InterpolateHermite(const RelativeState* start, const RelativeState* end, double dt, double s, RelativeState* out);
+static double getLength(const double* v);
+
+/**
+ * @brief Constructs a tracker for the asteroids of sim, all due next step
+ */
+EncounterTracker* constructEncounterTracker(const OrbitalSim* sim) {
+    EncounterTracker* tracker = new EncounterTracker();
+    tracker->systemBodies = sim->systemBodies;
+    tracker->numBodies = sim->numBodies;
+    tracker->sphereRadii.assign(sim->systemBodies, 0.0);
+    memset(&tracker->memory, 0, sizeof(tracker->memory));
+    setAccountedMemory(&tracker->memory, MEMORY_SPATIAL_INDEX, getEncounterTrackerBytes(sim->numBodies));
+
+    restartEncounterTracker(tracker);
+    return tracker;
+}
+
+/**
+ * @brief Destroys a tracker
+ */
+void destroyEncounterTracker(EncounterTracker* tracker) {
+    if (!tracker) return;
+    releaseAccountedMemory(&tracker->memory);
+    delete tracker;
+}
+
+/**
+ * @brief Drops the encounters in progress and schedules every asteroid for
+ * the next step (after the state jumped, e.g. copied from another simulation)
+ */
+void restartEncounterTracker(EncounterTracker* tracker) {
+    std::vector<EncounterCheck> checks;
+    checks.reserve(tracker->numBodies - tracker->systemBodies);
+    for (int i = tracker->systemBodies; i < tracker->numBodies; i++) {
+        EncounterCheck check = { 0, i };
+        checks.push_back(check);
+    }
+
+    // Every key is equal: the vector is already a heap
+    tracker->schedule = std::priority_queue<EncounterCheck, std::vector<EncounterCheck>,
+        std::greater<EncounterCheck> >(std::greater<EncounterCheck>(), std::move(checks));
+    tracker->active.clear();
+}
+
+/**
+ * @brief Checks the asteroids due at the end of the current step and
+ * follows the encounters in progress. Runs before sim->time advances.
+ * Returns the number of close approaches completed.
+ */
+int trackEncounters(EncounterTracker* tracker, const OrbitalSim* sim) {
+    const OrbitalBody* bodies = sim->bodies;
+    if (sim->numBodies == 0 || !bodies[0].isAlive) return 0;
+
+    // Encounter spheres: a multiple of the Hill radius around the central body
+    for (int p = 1; p < tracker->systemBodies; p++) {
+        double distance = Vector3Distance(bodies[p].position, bodies[0].position);
+        double hill = distance * cbrt(bodies[p].mass / (3.0 * bodies[0].mass));
+        tracker->sphereRadii[p] = bodies[p].isAlive ? sim->config.encounterHillRadii * hill : 0.0;
+    }
+
+    long long step = llround(sim->time / sim->timeStep) + 1;
+    size_t completed = tracker->approaches.size();
+
+    // Encounters in progress
+    for (size_t e = 0; e < tracker->active.size();) {
+        Encounter* encounter = &tracker->active[e];
+        const OrbitalBody* asteroid = &bodies[encounter->asteroid];
+        const OrbitalBody* planet = &bodies[encounter->planet];
+
+        bool inside = asteroid->isAlive && planet->isAlive;
+        if (inside) {
+            RefineClosestApproach(sim, encounter);
+            inside = Vector3Distance(asteroid->position, planet->position) < tracker->sphereRadii[encounter->planet];
+        }
+        if (inside) {
+            e++;
+            continue;
+        }
+
+        finishEncounter(tracker, encounter);
+        if (asteroid->isAlive) {
+            EncounterCheck check = { step + 1, encounter->asteroid };
+            tracker->schedule.push(check);
+        }
+        tracker->active[e] = tracker->active.back();
+        tracker->active.pop_back();
+    }
+
+    // Asteroids whose earliest possible entry has come
+    while (!tracker->schedule.empty() && tracker->schedule.top().step <= step) {
+        int asteroid = tracker->schedule.top().asteroid;
+        tracker->schedule.pop();
+        if (!bodies[asteroid].isAlive) continue; // Gone for good
+
+        int planet;
+        long long next = getNextCheck(tracker, sim, asteroid, step, &planet);
+        if (next > step) {
+            EncounterCheck check = { next, asteroid };
+            tracker->schedule.push(check);
+            continue;
+        }
+
+        Encounter encounter;
+        encounter.asteroid = asteroid;
+        encounter.planet = planet;
+        encounter.hillRadius = tracker->sphereRadii[planet] / sim->config.encounterHillRadii;
+        encounter.closestTime = sim->time + sim->timeStep;
+        encounter.closestDistance = Vector3Distance(bodies[asteroid].position, bodies[planet].position);
+        encounter.closestSpeed = Vector3Distance(bodies[asteroid].velocity, bodies[planet].velocity);
+        tracker->active.push_back(encounter);
+    }
+
+    if (tracker->approaches.capacity() * sizeof(CloseApproach) != tracker->memory.bytes[MEMORY_OUTPUT_BUFFERS]) {
+        setAccountedMemory(&tracker->memory, MEMORY_OUTPUT_BUFFERS, tracker->approaches.capacity() * sizeof(CloseApproach));
+    }
+    return (int)(tracker->approaches.size() - completed);
+}
+
+/**
+ * @brief Bytes of the schedule of a tracker over count bodies
+ */
+size_t getEncounterTrackerBytes(int count) {
+    return sizeof(EncounterCheck) * (size_t)count;
+}
+
+/**
+ * @brief Close approaches completed so far
+ */
+const CloseApproach* getCloseApproaches(const EncounterTracker* tracker, int* count) {
+    *count = (int)tracker->approaches.size();
+    return tracker->approaches.empty() ? NULL : &tracker->approaches[0];
+}
+
+/**
+ * @brief Writes the close approaches as CSV (one line per approach)
+ */
+bool writeApproachTable(const OrbitalSim* sim, const char* path) {
+    if (!sim->encounters) return false;
+
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Cannot write approach table to %s\n", path);
+        return false;
+    }
+
+    int count;
+    const CloseApproach* approaches = getCloseApproaches(sim->encounters, &count);
+    fprintf(file, "asteroid,planet,time,distance,relative_speed,hill_radii\n");
+    for (int i = 0; i < count; i++) {
+        const CloseApproach* approach = &approaches[i];
+        const char* name = sim->metadata[approach->planet].name;
+        fprintf(file, "%d,%s,%.1f,%g,%g,%g\n", approach->asteroid, name ? name : "",
+            approach->time, approach->distance, approach->relativeSpeed, approach->hillRadii);
+    }
+
+    fclose(file);
+    return true;
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief First step at whose end the asteroid could be inside an encounter
+ * sphere: the gap to each sphere over a bound on the closing speed (twice
+ * the sum of both speeds around the central body). Returns step, with the
+ * planet, if it already is inside one.
+ *
+ * The black hole can speed both bodies up far beyond that bound, so while it
+ * is active the gap also covers twice its pull on them (1/2 a t^2) and the
+ * wait is capped at ENCOUNTER_BLACK_HOLE_WAIT steps.
+ */
+static long long getNextCheck(const EncounterTracker* tracker, const OrbitalSim* sim, int asteroid, long long step, int* planet) {
+    const OrbitalBody* bodies = sim->bodies;
+    const OrbitalBody* body = &bodies[asteroid];
+    double speed = Vector3Distance(body->velocity, bodies[0].velocity);
+    double wait = sim->blackHole.isActive ? ENCOUNTER_BLACK_HOLE_WAIT : ENCOUNTER_MAX_WAIT;
+    double pull = getBlackHolePull(sim, body->position);
+
+    for (int p = 1; p < tracker->systemBodies; p++) {
+        double radius = tracker->sphereRadii[p];
+        if (radius <= 0.0) continue;
+
+        double gap = Vector3Distance(body->position, bodies[p].position) - radius;
+        if (gap < 0.0) {
+            *planet = p;
+            return step;
+        }
+
+        double closing = ENCOUNTER_SPEED_MARGIN * (speed + Vector3Distance(bodies[p].velocity, bodies[0].velocity));
+        double acceleration = ENCOUNTER_SPEED_MARGIN * (pull + getBlackHolePull(sim, bodies[p].position));
+
+        // Root of closing t + acceleration t^2 / 2 = gap, stable when acceleration is 0
+        double time = 2.0 * gap / (closing + sqrt(closing * closing + 2.0 * acceleration * gap));
+        wait = fmin(wait, time / sim->timeStep);
+    }
+
+    *planet = -1;
+    return step + ((wait > 1.0) ? (long long)wait : 1);
+}
+
+/**
+ * @brief Acceleration of the black hole on a body at position (0 if none)
+ */
+static double getBlackHolePull(const OrbitalSim* sim, Vector3 position) {
+    if (!sim->blackHole.isActive) return 0.0;
+
+    double distanceSq = Vector3DistanceSqr(position, sim->blackHole.position);
+    double radius = sim->blackHole.radius;
+    return GRAVITATIONAL_CONSTANT * sim->blackHole.mass / fmax(distanceSq, radius * radius);
+}
+
+/**
+ * @brief Records and logs the closest approach of a finished encounter
+ */
+static void finishEncounter(EncounterTracker* tracker, const Encounter* encounter) {
+    CloseApproach approach;
+    approach.asteroid = encounter->asteroid;
+    approach.planet = encounter->planet;
+    approach.time = encounter->closestTime;
+    approach.distance = (float)encounter->closestDistance;
+    approach.relativeSpeed = (float)encounter->closestSpeed;
+    approach.hillRadii = (float)(encounter->closestDistance / encounter->hillRadius);
+    tracker->approaches.push_back(approach);
+
+    logEvent(EVENT_CLOSE_APPROACH, (uint32_t)approach.asteroid, approach.time, approach.distance, approach.planet);
+    addMetric(METRIC_CLOSE_APPROACHES, 1);
+}
+
+/**
+ * @brief Closest approach during the last step. Semi-implicit Euler moves
+ * both bodies in a straight line, with the velocity of the middle of the
+ * step; the velocities at the ends are recovered with half a kick of the
+ * relative acceleration (v -+ a dt / 2), and the relative position is
+ * interpolated with the cubic Hermite curve through both end states.
+ */
+static void RefineClosestApproach(const OrbitalSim* sim, Encounter* encounter) {
+    const OrbitalBody* asteroid = &sim->bodies[encounter->asteroid];
+    const OrbitalBody* planet = &sim->bodies[encounter->planet];
+    double dt = sim->timeStep;
+
+    RelativeState start, end;
+    double startAcceleration[3], endAcceleration[3];
+    GetRelativeAcceleration(sim, encounter->asteroid, encounter->planet, dt, startAcceleration);
+    GetRelativeAcceleration(sim, encounter->asteroid, encounter->planet, 0.0, endAcceleration);
+
+    double middle[3] = {
+        (double)asteroid->velocity.x - planet->velocity.x,
+        (double)asteroid->velocity.y - planet->velocity.y,
+        (double)asteroid->velocity.z - planet->velocity.z
+    };
+    end.r[0] = (double)asteroid->position.x - planet->position.x;
+    end.r[1] = (double)asteroid->position.y - planet->position.y;
+    end.r[2] = (double)asteroid->position.z - planet->position.z;
+    for (int axis = 0; axis < 3; axis++) {
+        start.r[axis] = end.r[axis] - middle[axis] * dt;
+        start.v[axis] = middle[axis] - 0.5 * dt * startAcceleration[axis];
+        end.v[axis] = middle[axis] + 0.5 * dt * endAcceleration[axis];
+    }
+
+    // Best sample, then golden-section search around it
+    RelativeState state;
+    int best = 0;
+    double bestDistance = INFINITY;
+    for (int k = 0; k <= ENCOUNTER_SAMPLES; k++) {
+        InterpolateHermite(&start, &end, dt, (double)k / ENCOUNTER_SAMPLES, &state);
+        double distance = getLength(state.r);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = k;
+        }
+    }
+
+    const double ratio = 0.5 * (sqrt(5.0) - 1.0);
+    double low = (best > 0) ? (double)(best - 1) / ENCOUNTER_SAMPLES : 0.0;
+    double high = (best < ENCOUNTER_SAMPLES) ? (double)(best + 1) / ENCOUNTER_SAMPLES : 1.0;
+    for (int i = 0; i < ENCOUNTER_REFINE_ITERATIONS; i++) {
+        double s1 = high - ratio * (high - low);
+        double s2 = low + ratio * (high - low);
+        InterpolateHermite(&start, &end, dt, s1, &state);
+        double d1 = getLength(state.r);
+        InterpolateHermite(&start, &end, dt, s2, &state);
+        double d2 = getLength(state.r);
+        if (d1 < d2) high = s2;
+        else low = s1;
+    }
+
+    double s = 0.5 * (low + high);
+    InterpolateHermite(&start, &end, dt, s, &state);
+    double distance = getLength(state.r);
+    if (distance < encounter->closestDistance) {
+        encounter->closestDistance = distance;
+        encounter->closestTime = sim->time + s * dt;
+        encounter->closestSpeed = getLength(state.v);
+    }
+}
+
+/**
+ * @brief Acceleration of the asteroid relative to the planet, span seconds
+ * before the end of the step (positions moved back along the step): the
+ * planet pull plus the tide of the central body
+ */
+static void GetRelativeAcceleration(const OrbitalSim* sim, int asteroid, int planet, double span, double* acceleration) {
+    const OrbitalBody* bodies = sim->bodies;
+    int indices[3] = { asteroid, planet, 0 };
+    double positions[3][3];
+    for (int b = 0; b < 3; b++) {
+        const OrbitalBody* body = &bodies[indices[b]];
+        positions[b][0] = body->position.x - body->velocity.x * span;
+        positions[b][1] = body->position.y - body->velocity.y * span;
+        positions[b][2] = body->position.z - body->velocity.z * span;
+    }
+
+    double toPlanet[3], fromCenter[3], planetFromCenter[3];
+    for (int axis = 0; axis < 3; axis++) {
+        toPlanet[axis] = positions[1][axis] - positions[0][axis];
+        fromCenter[axis] = positions[0][axis] - positions[2][axis];
+        planetFromCenter[axis] = positions[1][axis] - positions[2][axis];
+    }
+
+    double planetPull = GRAVITATIONAL_CONSTANT * bodies[planet].mass / pow(getLength(toPlanet), 3);
+    double centerMu = GRAVITATIONAL_CONSTANT * bodies[0].mass;
+    double asteroidPull = centerMu / pow(getLength(fromCenter), 3);
+    double planetCenterPull = centerMu / pow(getLength(planetFromCenter), 3);
+    for (int axis = 0; axis < 3; axis++) {
+        acceleration[axis] = planetPull * toPlanet[axis] -
+            asteroidPull * fromCenter[axis] + planetCenterPull * planetFromCenter[axis];
+    }
+}
+
+/**
+ * @brief Cubic Hermite state at fraction s of a step of dt seconds
+ */
+static void InterpolateHermite(const RelativeState* start, const RelativeState* end, double dt, double s, RelativeState* out) {
+    double s2 = s * s;
+    double s3 = s2 * s;
+    double h00 = 2 * s3 - 3 * s2 + 1;
+    double h10 = s3 - 2 * s2 + s;
+    double h01 = -2 * s3 + 3 * s2;
+    double h11 = s3 - s2;
+    double d00 = 6 * s2 - 6 * s;
+    double d10 = 3 * s2 - 4 * s + 1;
+    double d11 = 3 * s2 - 2 * s;
+
+    for (int axis = 0; axis < 3; axis++) {
+        out->r[axis] = h00 * start->r[axis] + h10 * dt * start->v[axis] +
+            h01 * end->r[axis] + h11 * dt * end->v[axis];
+        out->v[axis] = (d00 * (start->r[axis] - end->r[axis])) / dt +
+            d10 * start->v[axis] + d11 * end->v[axis];
+    }
+}
+
+/**
+ * @brief Length of a double vector
+ */
+static double getLength(const double* v) {
+    return sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
@@ -0,0 +1,39 @@
+/**
+ * @brief Implements close-approach tracking between asteroids and planets
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef ENCOUNTERS_H
+#define ENCOUNTERS_H
+
+#include <stddef.h>
+
+struct OrbitalSim;
+struct EncounterTracker;
+
+/**
+ * @brief Closest approach of an asteroid to a planet during one passage
+ * through its encounter sphere
+ */
+struct CloseApproach {
+    int asteroid;          // Index in bodies
+    int planet;            // Index in bodies
+    double time;           // Simulation time of the closest approach [s]
+    float distance;        // Closest distance [m]
+    float relativeSpeed;   // Speed relative to the planet at that time [m/s]
+    float hillRadii;       // Closest distance in Hill radii of the planet
+};
+
+EncounterTracker* constructEncounterTracker(const OrbitalSim* sim);
+void destroyEncounterTracker(EncounterTracker* tracker);
+void restartEncounterTracker(EncounterTracker* tracker);
+int trackEncounters(EncounterTracker* tracker, const OrbitalSim* sim);
+size_t getEncounterTrackerBytes(int count);
+
+// Approaches completed since the tracker was constructed, in order
+const CloseApproach* getCloseApproaches(const EncounterTracker* tracker, int* count);
+bool writeApproachTable(const OrbitalSim* sim, const char* path);
+
+#endif
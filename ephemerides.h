@@ -19,10 +19,39 @@ struct EphemeridesBody
     Color color;	  // Raylib color
     Vector3 position; // [m]
     Vector3 velocity; // [m/s]
+    float j2;              // Oblateness coefficient (0: spherical)
+    float referenceRadius; // J2 reference radius [m]
+    Vector3 pole;          // Spin axis (unit, simulation axes)
+};
+
+struct EphemeridesMoon
+{
+    const char *name; // Name
+    int parent;       // Index of the planet in its system
+    float mass;       // [kg]
+    float radius;     // [m]
+    Color color;      // Raylib color
+    Vector3 position; // Relative to the planet [m]
+    Vector3 velocity; // Relative to the planet [m/s]
+};
+
+struct EphemeridesRing
+{
+    const char *name;      // Name
+    int parent;            // Index of the planet in its system
+    float j2;              // Oblateness coefficient of the planet
+    float referenceRadius; // J2 reference radius [m]
+    float innerRadius;     // [m]
+    float outerRadius;     // [m]
+    float gapInner;        // Largest gap [m]
+    float gapOuter;        // [m]
+    Vector3 pole;          // Spin axis of the planet (unit, simulation axes)
+    Color color;           // Raylib color
 };
 
 /**
- * @brief Solay system ephermerides for 2022-01-01T00:00:00Z
+ * @brief Solay system ephermerides for 2022-01-01T00:00:00Z. Oblateness of
+ * the planets (J2 read by their moons), poles from the IAU rotational elements.
  * 
  * @cite https://ssd.jpl.nasa.gov/horizons/app.html#/
 */
@@ -35,6 +64,9 @@ EphemeridesBody solarSystem[] = {
         GOLD,
         {-1.283674643550172E+09F, 2.589397504295033E+07F, 5.007104996950605E+08F},
         {-5.809369653802155E-00F, 2.513455442031695E-01F, -1.461959576560110E+01F},
+        0.0F,
+        0.0F,
+        {0.0F, 0.0F, 0.0F},
     },
     {
         "Mercurio",
@@ -43,6 +75,9 @@ EphemeridesBody solarSystem[] = {
         GRAY,
         {5.242617205495467E+10F, -5.398976570474024E+09F, -5.596063357617276E+09F},
         {-3.931719860392732E+03F, 4.493726800433638E+03F, 5.056613955108243E+04F},
+        0.0F,
+        0.0F,
+        {0.0F, 0.0F, 0.0F},
     },
     {
         "Venus",
@@ -51,6 +86,9 @@ EphemeridesBody solarSystem[] = {
         BEIGE,
         {-1.143612889654620E+10F, 2.081921801192194E+09F, 1.076180391552140E+11F},
         {-3.498958532524220E+04F, 1.971012081662609E+03F, -3.509011592387367E+03F},
+        0.0F,
+        0.0F,
+        {0.0F, 0.0F, 0.0F},
     },
     {
         "Tierra",
@@ -59,6 +97,9 @@ EphemeridesBody solarSystem[] = {
         BLUE,
         {-2.741147560901964E+10F, 1.907499306293577E+07F, 1.452697499646169E+11F},
         {-2.981801522121922E+04F, 1.781036907294364E00F, -5.415519940416356E+03F},
+        1082.63E-6F,
+        6378.14E3F,
+        {0.0F, 9.174821E-01F, 3.977772E-01F},
     },
     {
         "Marte",
@@ -67,6 +108,9 @@ EphemeridesBody solarSystem[] = {
         RED,
         {-1.309510737126251E+11F, -7.714450109843910E+08F, -1.893127398896606E+11F},
         {2.090994471204196E+04F, -7.557181497936503E02F, -1.160503586188451E+04F},
+        1960.45E-6F,
+        3396.19E3F,
+        {4.461505E-01F, 8.932349E-01F, -5.550828E-02F},
     },
     {
         "Jupiter",
@@ -75,6 +119,9 @@ EphemeridesBody solarSystem[] = {
         BEIGE,
         {6.955554713494443E+11F, -1.444959769995748E+10F, -2.679620040967891E+11F},
         {4.539612624165795E+03F, -1.547160200183022E+02F, 1.280513202430234E+04F},
+        14736E-6F,
+        71492E3F,
+        {-1.459926E-02F, 9.992517E-01F, -3.581847E-02F},
     },
     {
         "Saturno",
@@ -83,6 +130,9 @@ EphemeridesBody solarSystem[] = {
         LIGHTGRAY,
         {1.039929189378534E+12F, -2.303100000185490E+10F, -1.056650101932204E+12F},
         {6.345150006906061E+03F, -3.704447055166629E+02F, 6.756117358248296E+03F},
+        16290.7E-6F,
+        60330E3F,
+        {8.547883E-02F, 8.825221E-01F, 4.624372E-01F},
     },
     {
         "Urano",
@@ -91,6 +141,9 @@ EphemeridesBody solarSystem[] = {
         SKYBLUE,
         {2.152570437700128E+12F, -2.039611192913723E+10F, 2.016888245555490E+12F},
         {-4.705853565766252E+03F, 7.821724397220797E+01F, 4.652144641704226E+03F},
+        3343.43E-6F,
+        25559E3F,
+        {-2.119996E-01F, 1.343632E-01F, -9.679890E-01F},
     },
     {
         "Neptuno",
@@ -99,11 +152,87 @@ EphemeridesBody solarSystem[] = {
         DARKBLUE,
         {4.431790029686977E+12F, -8.954348456482631E+10F, -6.114486878028781E+11F},
         {7.066237951457524E+02F, -1.271365751559108E+02F, 5.417076605926207E+03F},
+        3411E-6F,
+        25225E3F,
+        {3.558833E-01F, 8.827313E-01F, -3.068103E-01F},
     },
 };
 
 #define SOLARSYSTEM_BODYNUM (sizeof(solarSystem) / sizeof(EphemeridesBody))
 
+/**
+ * @brief Solar system moons, grouped by planet. Circular orbits with the mean
+ * distance and the inclination to the ecliptic; the phases are illustrative.
+ */
+
+EphemeridesMoon solarSystemMoons[] = {
+    {
+        "Luna",
+        3,
+        7.34200E+22F,
+        1.7374E+06F,
+        LIGHTGRAY,
+        {2.944674839E+08F, 2.215796170E+07F, 2.460920268E+08F},
+        {-6.585651317E+02F, 7.038241010E+01F, 7.816851651E+02F},
+    },
+    {
+        "Io",
+        5,
+        8.93190E+22F,
+        1.8216E+06F,
+        YELLOW,
+        {4.217000000E+08F, 0, 0},
+        {0, 6.653867183E+02F, 1.732050587E+04F},
+    },
+    {
+        "Europa",
+        5,
+        4.79980E+22F,
+        1.5608E+06F,
+        RAYWHITE,
+        {-3.355170000E+08F, 2.230840311E+07F, 5.807041476E+08F},
+        {-1.189970634E+04F, -2.637357133E+02F, -6.865234674E+03F},
+    },
+    {
+        "Ganimedes",
+        5,
+        1.48190E+23F,
+        2.6341E+06F,
+        GRAY,
+        {-3.661024657E+08F, -3.861269476E+07F, -1.005116856E+09F},
+        {1.022350157E+04F, -1.428429671E+02F, -3.718307537E+03F},
+    },
+    {
+        "Calisto",
+        5,
+        1.07590E+23F,
+        2.4103E+06F,
+        DARKGRAY,
+        {9.413545000E+08F, -6.259031780E+07F, -1.629272026E+09F},
+        {7.104339781E+03F, 1.574549880E+02F, 4.098669195E+03F},
+    },
+};
+
+#define SOLARSYSTEM_MOONNUM (sizeof(solarSystemMoons) / sizeof(EphemeridesMoon))
+
+/**
+ * @brief Saturn main rings (C ring inner edge to A ring outer edge, with the
+ * Cassini division). Pole from the IAU rotational elements.
+ */
+
+EphemeridesRing saturnRings = {
+    "Anillos de Saturno",
+    6,
+    16290.7E-6F,
+    60330E3F,
+    74658E3F,
+    136775E3F,
+    117580E3F,
+    122170E3F,
+    {8.547883E-02F, 8.825221E-01F, 4.624372E-01F},
+    {210, 190, 150, 255},
+};
+
 /**
  * Alpha Centauri system ephermerides for 2022-01-01T00:00:00Z
  * 
@@ -118,6 +247,9 @@ EphemeridesBody alphaCentauriSystem[] = {
         YELLOW,
         {7.76412948E+11F, 0, 0},
         {0, 0, 7.120E+03F},
+        0.0F,
+        0.0F,
+        {0.0F, 0.0F, 0.0F},
     },
     {
         "Alfa Centauri B",
@@ -126,6 +258,9 @@ EphemeridesBody alphaCentauriSystem[] = {
         GOLD,
         {-9.20026904E+11F, 0, 0},
         {0, 0, -8.430E03F},
+        0.0F,
+        0.0F,
+        {0.0F, 0.0F, 0.0F},
     },
 };
 
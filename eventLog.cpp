@@ -0,0 +1,233 @@
+/**
+ * @brief Implements a low-overhead binary event log
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "eventLog.h"
+#include "memoryStats.h"
+
+#define EVENTLOG_RING_CAPACITY 4096 // Power of two
+#define EVENTLOG_DRAIN_INTERVAL 10  // [ms]
+
+/**
+ * @brief Single-producer single-consumer ring owned by one thread. The owner
+ * advances head, the drain thread advances tail.
+ */
+struct EventRing {
+    EventRecord records[EVENTLOG_RING_CAPACITY];
+    std::atomic<uint32_t> head;
+    char padding[64];       // Keeps head and tail on separate cache lines
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> dropped;
+    std::atomic<bool> inUse;
+    uint16_t thread;
+    EventRing* next;
+};
+
+/**
+ * @brief Releases the thread ring when its thread exits. Pending records
+ * are still drained and the ring is reused by the next new thread.
+ */
+struct EventRingOwner {
+    EventRing* ring;
+    ~EventRingOwner() {
+        if (ring) ring->inUse.store(false, std::memory_order_release);
+    }
+};
+
+static std::atomic<bool> eventLogEnabled(false);
+static std::atomic<EventRing*> eventRings(NULL);
+static std::atomic<uint16_t> eventRingCount(0);
+static thread_local EventRingOwner eventRingOwner = { NULL };
+
+// Drain thread
+static FILE* eventFile = NULL;
+static std::thread drainThread;
+static std::mutex drainLock;
+static std::condition_variable drainWake;
+static bool drainRunning = false;
+
+static EventRing* getThreadRing(void);
+static uint64_t getMonotonicNs(void);
+static void drainRings(void);
+static void runDrain(void);
+
+/**
+ * @brief Opens the log file and starts the drain thread
+ */
+bool startEventLog(const char* path) {
+    if (!path || drainRunning) return false;
+
+    eventFile = fopen(path, "wb");
+    if (!eventFile) {
+        printf("Event log: cannot open %s\n", path);
+        return false;
+    }
+
+    uint32_t magic = EVENTLOG_MAGIC;
+    uint16_t version = EVENTLOG_VERSION;
+    uint16_t recordSize = sizeof(EventRecord);
+    fwrite(&magic, sizeof(magic), 1, eventFile);
+    fwrite(&version, sizeof(version), 1, eventFile);
+    fwrite(&recordSize, sizeof(recordSize), 1, eventFile);
+
+    drainRunning = true;
+    eventLogEnabled.store(true, std::memory_order_release);
+    drainThread = std::thread(runDrain);
+    return true;
+}
+
+/**
+ * @brief Stops logging, drains what is left and closes the file
+ */
+void stopEventLog(void) {
+    {
+        std::lock_guard<std::mutex> guard(drainLock);
+        if (!drainRunning) return;
+        drainRunning = false;
+    }
+    eventLogEnabled.store(false, std::memory_order_release);
+    drainWake.notify_all();
+    drainThread.join();
+
+    fclose(eventFile);
+    eventFile = NULL;
+}
+
+/**
+ * @brief Appends an event to the calling thread ring. Never blocks: when the
+ * ring is full the event is counted as dropped.
+ */
+void logEvent(EventType type, uint32_t index, double simTime, double value, double extra) {
+    if (!eventLogEnabled.load(std::memory_order_relaxed)) return;
+
+    EventRing* ring = getThreadRing();
+    if (!ring) return;
+
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= EVENTLOG_RING_CAPACITY) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    EventRecord* record = &ring->records[head & (EVENTLOG_RING_CAPACITY - 1)];
+    record->wallTime = getMonotonicNs();
+    record->type = (uint16_t)type;
+    record->thread = ring->thread;
+    record->index = index;
+    record->simTime = simTime;
+    record->value = value;
+    record->extra = extra;
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Logs a batch of fate events (e.g. those of the last step)
+ */
+void logFateEvents(const FateEvent* events, int count) {
+    if (!eventLogEnabled.load(std::memory_order_relaxed)) return;
+
+    for (int i = 0; i < count; i++) {
+        if (events[i].fate == BODY_FATE_MERGED) {
+            logEvent(EVENT_MERGE, (uint32_t)events[i].body, events[i].time, events[i].relativeSpeed, events[i].target);
+            continue;
+        }
+        logEvent(events[i].fate == BODY_FATE_EJECTED ? EVENT_EJECTION : EVENT_ACCRETION,
+            (uint32_t)events[i].body, events[i].time, events[i].relativeSpeed, events[i].blackHoleMass);
+    }
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Returns the calling thread ring, claiming a free one or adding one
+ */
+static EventRing* getThreadRing(void) {
+    if (eventRingOwner.ring) return eventRingOwner.ring;
+
+    for (EventRing* ring = eventRings.load(std::memory_order_acquire); ring; ring = ring->next) {
+        bool expected = false;
+        if (ring->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            eventRingOwner.ring = ring;
+            return ring;
+        }
+    }
+
+    EventRing* ring = new EventRing();
+    addMemoryUsage(MEMORY_OUTPUT_BUFFERS, sizeof(EventRing));
+    ring->head.store(0);
+    ring->tail.store(0);
+    ring->dropped.store(0);
+    ring->inUse.store(true);
+    ring->thread = eventRingCount.fetch_add(1);
+
+    // Lock-free push; rings are never removed so the drain can walk the list
+    EventRing* first = eventRings.load(std::memory_order_relaxed);
+    do {
+        ring->next = first;
+    } while (!eventRings.compare_exchange_weak(first, ring, std::memory_order_release, std::memory_order_relaxed));
+
+    eventRingOwner.ring = ring;
+    return ring;
+}
+
+/**
+ * @brief Monotonic clock in nanoseconds
+ */
+static uint64_t getMonotonicNs(void) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Writes every pending record to the file
+ */
+static void drainRings(void) {
+    for (EventRing* ring = eventRings.load(std::memory_order_acquire); ring; ring = ring->next) {
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+
+        while (tail != head) {
+            uint32_t offset = tail & (EVENTLOG_RING_CAPACITY - 1);
+            uint32_t count = head - tail;
+            if (count > EVENTLOG_RING_CAPACITY - offset) count = EVENTLOG_RING_CAPACITY - offset;
+
+            fwrite(&ring->records[offset], sizeof(EventRecord), count, eventFile);
+            tail += count;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+
+        // Report overflows in-band
+        uint32_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            EventRecord record = { getMonotonicNs(), EVENT_DROPPED, ring->thread, ring->thread, 0.0, (double)dropped, 0.0 };
+            fwrite(&record, sizeof(record), 1, eventFile);
+        }
+    }
+}
+
+/**
+ * @brief Drain thread
+ */
+static void runDrain(void) {
+    bool running = true;
+    while (running) {
+        {
+            std::unique_lock<std::mutex> guard(drainLock);
+            drainWake.wait_for(guard, std::chrono::milliseconds(EVENTLOG_DRAIN_INTERVAL), [] { return !drainRunning; });
+            running = drainRunning;
+        }
+        drainRings();
+    }
+    fflush(eventFile);
+}
@@ -0,0 +1,63 @@
+/**
+ * @brief Implements a low-overhead binary event log
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h>
+
+#include "orbitalSim.h"
+
+#define EVENTLOG_MAGIC 0x5456454F // "OEVT"
+#define EVENTLOG_VERSION 2
+
+/**
+ * @brief Event kinds. Meaning of index/value/extra per kind:
+ * ACCRETION / EJECTION: body index, relative speed [m/s], black hole mass [kg]
+ * MERGE: absorbed body index, relative speed [m/s], index of the body it merged into
+ * CLOSE_APPROACH: asteroid index, closest distance [m], planet index (at the time of closest approach)
+ * BLACK_HOLE_CREATED: 0, black hole mass [kg]
+ * RESET: new body count, new generation
+ * LOD_CHANGE: 0, new LOD multiplier
+ * MODEL_LOADED / MODEL_FAILED: 0, 0
+ * WORKER_LOST: worker index (-1 as uint32_t if the coordinator itself failed), 0
+ * DROPPED: thread of the ring that overflowed, events lost
+ */
+typedef enum {
+    EVENT_ACCRETION,
+    EVENT_BLACK_HOLE_CREATED,
+    EVENT_RESET,
+    EVENT_LOD_CHANGE,
+    EVENT_MODEL_LOADED,
+    EVENT_MODEL_FAILED,
+    EVENT_WORKER_LOST,
+    EVENT_DROPPED,
+    EVENT_EJECTION,
+    EVENT_MERGE,
+    EVENT_CLOSE_APPROACH
+} EventType;
+
+/**
+ * @brief On-disk record (native endianness). The file starts with
+ * uint32 magic, uint16 version, uint16 record size.
+ */
+struct EventRecord {
+    uint64_t wallTime;  // Monotonic clock [ns]
+    uint16_t type;      // EventType
+    uint16_t thread;    // Ring that recorded it
+    uint32_t index;
+    double simTime;     // Simulation time [s], 0 when not applicable
+    double value;
+    double extra;
+};
+
+bool startEventLog(const char* path);
+void stopEventLog(void);
+void logEvent(EventType type, uint32_t index, double simTime, double value, double extra);
+void logFateEvents(const FateEvent* events, int count);
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @brief Implements the optional force terms as compile-time policies
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * Each term is a struct with a static add() that the force kernels call at
+ * a fixed point of their inner loop. The kernels are templates on the terms
+ * and are instantiated once per combination; the combination is picked once
+ * per step from SimConfig.forceTerms. A disabled term is an empty inline
+ * function (its inputs are dead code), an enabled one is inlined in place.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef FORCES_H
+#define FORCES_H
+
+#include <math.h>
+
+#include "raylib.h"
+
+#define SPEED_OF_LIGHT 299792458.0 // [m/s]
+#define SOLAR_MASS 1.9885E30       // [kg]
+#define SOLAR_LUMINOSITY 3.828E26  // [W]
+
+/**
+ * @brief Bits of SimConfig.forceTerms
+ */
+enum ForceTerm {
+    FORCE_TERM_RELATIVITY = 1, // Post-Newtonian correction of the star pull (planets, asteroids)
+    FORCE_TERM_OBLATENESS = 2, // J2 of the planets on their moons
+    FORCE_TERM_RADIATION = 4   // Radiation pressure of the star on asteroids
+};
+
+/**
+ * @brief Central star, as seen by the star and body terms
+ */
+struct StarTerms {
+    double mu;        // G M [m^3/s^2]
+    double radiation; // L / (4 pi c): radiation force on 1 m^2 at 1 m [N]
+};
+
+/**
+ * @brief Oblate planet, as seen by the planet terms
+ */
+struct PlanetTerms {
+    double mu;        // G M [m^3/s^2]
+    double j2R2;      // J2 times the squared reference radius [m^2]
+    Vector3 pole;     // Spin axis (unit)
+};
+
+/**
+ * @brief Star terms of the central star of mass mass. The luminosity follows
+ * the main-sequence mass-luminosity relation L ~ M^4.
+ */
+static inline StarTerms getStarTerms(double mu, double mass) {
+    double solarMasses = mass / SOLAR_MASS;
+    double luminosity = SOLAR_LUMINOSITY * solarMasses * solarMasses * solarMasses * solarMasses;
+    StarTerms star = { mu, luminosity / (4.0 * PI * SPEED_OF_LIGHT) };
+    return star;
+}
+
+/**
+ * @brief Newtonian star pull only
+ */
+struct NoStarTerm {
+    static inline void add(const StarTerms&, Vector3, Vector3, Vector3*) {}
+};
+
+/**
+ * @brief First post-Newtonian (Schwarzschild, harmonic gauge) correction of
+ * the star pull on a test body at r with velocity v, both relative to the
+ * star: mu / (c^2 r^3) [(4 mu / r - v^2) r + 4 (r.v) v]
+ */
+struct RelativityTerm {
+    static inline void add(const StarTerms& star, Vector3 r, Vector3 v, Vector3* acceleration) {
+        double rSq = (double)r.x * r.x + (double)r.y * r.y + (double)r.z * r.z;
+        double distance = sqrt(rSq);
+        double vSq = (double)v.x * v.x + (double)v.y * v.y + (double)v.z * v.z;
+        double rv = (double)r.x * v.x + (double)r.y * v.y + (double)r.z * v.z;
+
+        double scale = star.mu / (SPEED_OF_LIGHT * SPEED_OF_LIGHT * rSq * distance);
+        double radial = scale * (4.0 * star.mu / distance - vSq);
+        double along = scale * 4.0 * rv;
+        acceleration->x += (float)(radial * r.x + along * v.x);
+        acceleration->y += (float)(radial * r.y + along * v.y);
+        acceleration->z += (float)(radial * r.z + along * v.z);
+    }
+};
+
+/**
+ * @brief No non-gravitational force on asteroids
+ */
+struct NoBodyTerm {
+    static inline void add(const StarTerms&, Vector3, double, Vector3*) {}
+};
+
+/**
+ * @brief Radiation pressure of the star on a body at r from it, with
+ * cross-section / mass areaToMass [m^2/kg] (black body, radially outward)
+ */
+struct RadiationTerm {
+    static inline void add(const StarTerms& star, Vector3 r, double areaToMass, Vector3* acceleration) {
+        double rSq = (double)r.x * r.x + (double)r.y * r.y + (double)r.z * r.z;
+        double scale = star.radiation * areaToMass / (rSq * sqrt(rSq));
+        acceleration->x += (float)(scale * r.x);
+        acceleration->y += (float)(scale * r.y);
+        acceleration->z += (float)(scale * r.z);
+    }
+};
+
+/**
+ * @brief Spherical planets
+ */
+struct NoPlanetTerm {
+    static inline void add(const PlanetTerms&, Vector3, Vector3*) {}
+};
+
+/**
+ * @brief J2 pull of an oblate planet on a body at r from it:
+ * -3/2 J2 mu R^2 / r^5 [(1 - 5 z^2 / r^2) r + 2 z pole], z along the pole
+ */
+struct OblatenessTerm {
+    static inline void add(const PlanetTerms& planet, Vector3 r, Vector3* acceleration) {
+        double rSq = (double)r.x * r.x + (double)r.y * r.y + (double)r.z * r.z;
+        double z = (double)r.x * planet.pole.x + (double)r.y * planet.pole.y + (double)r.z * planet.pole.z;
+
+        double scale = -1.5 * planet.mu * planet.j2R2 / (rSq * rSq * sqrt(rSq));
+        double radial = scale * (1.0 - 5.0 * z * z / rSq);
+        double polar = scale * 2.0 * z;
+        acceleration->x += (float)(radial * r.x + polar * planet.pole.x);
+        acceleration->y += (float)(radial * r.y + polar * planet.pole.y);
+        acceleration->z += (float)(radial * r.z + polar * planet.pole.z);
+    }
+};
+
+#endif
@@ -0,0 +1,519 @@
+/**
+ * @brief Implements the hybrid symplectic integrator of the asteroids
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * Wisdom-Holman map relative to the central star: each step an asteroid is
+ * kicked by everything but the star, then follows its exact Kepler orbit
+ * around it. The star moves in a straight line during the step
+ * (semi-implicit Euler), so that frame is inertial between kicks and the
+ * kick includes the star acceleration.
+ *
+ * Planets, other stars and the black hole are split with a smooth
+ * changeover function of the distance (MERCURY, Chambers 1999): far away
+ * their pull goes into the kick; within the changeover radius it is handed
+ * over to a Bulirsch-Stoer integration of the whole step, together with the
+ * star pull, with the perturbers moving along their straight paths. Only
+ * the asteroids near a perturber pay for it. The pulls are not softened
+ * outside the radius of the body.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "hybrid.h"
+#include "orbitalSim.h"
+
+#define GRAVITATIONAL_CONSTANT 6.6743E-11
+#define KEPLER_MAX_ITERATIONS 20
+#define HYBRID_CHANGEOVER_STEPS 100.0  // Changeover where the dynamical time around a perturber is this many steps
+#define HYBRID_INNER_FRACTION 0.1      // Inside this fraction of the changeover radius the whole pull is integrated
+#define HYBRID_TOLERANCE 1E-12         // Relative error of a Bulirsch-Stoer substep
+#define HYBRID_MAX_COLUMNS 8           // Extrapolation columns: 2, 4, ..., 16 midpoint steps
+#define HYBRID_MIN_SUBSTEP 1E-9        // Smallest substep / step, accepted even if not converged
+
+/**
+ * @brief Body pulling on the asteroids, relative to the central star
+ */
+struct Perturber {
+    double position[3];  // At the start of the step [m]
+    double velocity[3];  // Constant over the step [m/s]
+    double mu;           // G m [m^3/s^2]
+    double radius;       // Inside it the pull falls off as in a uniform sphere [m]
+    double changeover;   // Changeover radius [m]
+    double reach;        // Distance moved in the step [m]
+};
+
+/**
+ * @brief Everything an asteroid step needs besides its own state
+ */
+struct HybridStep {
+    const Perturber* perturbers;
+    int count;
+    double mu;           // Of the central star
+    double radius;       // Of the central star
+    double dt;
+};
+
+static int getPerturbers(const OrbitalSim* sim, Perturber* perturbers);
+static void loadState(const OrbitalSim* sim, int index, double position[3], double velocity[3]);
+static void storeState(OrbitalSim* sim, int index, const double position[3], const double velocity[3]);
+static double GetChangeoverRadius(double mass, double dt);
+static double GetChangeover(double distance, double radius);
+static bool AddFarPull(const HybridStep* step, const double position[3], double acceleration[3], double* clearance);
+static void AddPull(const Perturber* perturber, const double separation[3], double distance,
+    double weight, double acceleration[3]);
+static bool PassesClose(const HybridStep* step, const double start[3], const double end[3]);
+static void IntegrateEncounter(const HybridStep* step, double state[6]);
+static int BulirschStoerStep(const HybridStep* step, double t, double h, const double state[6], double result[6]);
+static void ModifiedMidpoint(const HybridStep* step, double t, double h, int substeps,
+    const double state[6], const double derivative[6], double result[6]);
+static void GetDerivative(const HybridStep* step, double t, const double state[6], double derivative[6]);
+static void GetStumpff(double z, double* c, double* s);
+static double getLength(const double v[3]);
+
+/**
+ * @brief Moves the asteroids in [begin, end) over one step. The system
+ * bodies, the black hole and the central star (bodies[0], alive) must have
+ * been advanced already. Perturber scratch comes from the arena: the caller
+ * rewinds it.
+ */
+void advanceHybridBodies(OrbitalSim* sim, int begin, int end) {
+    OrbitalBody* bodies = sim->bodies;
+    Perturber* perturbers = (Perturber*)allocateArena(sim->arena, getHybridBytes(sim->systemBodies));
+    if (!perturbers) return;
+
+    HybridStep step;
+    step.perturbers = perturbers;
+    step.count = getPerturbers(sim, perturbers);
+    step.mu = GRAVITATIONAL_CONSTANT * bodies[0].mass;
+    step.radius = sim->metadata[0].radius;
+    step.dt = sim->timeStep;
+
+    double centerEnd[3], centerVelocity[3];
+    loadState(sim, 0, centerEnd, centerVelocity);
+    double frame[3] = { sim->frameAcceleration.x, sim->frameAcceleration.y, sim->frameAcceleration.z };
+
+    for (int i = begin; i < end; i++) {
+        OrbitalBody* body = &bodies[i];
+        if (!body->isAlive || body->tier != BODY_TIER_FULL) continue;
+
+        double position[3], velocity[3];
+        loadState(sim, i, position, velocity);
+        double start[3];
+        for (int k = 0; k < 3; k++) {
+            start[k] = position[k] - (centerEnd[k] - centerVelocity[k] * step.dt);
+        }
+
+        // Kick: far part of the perturbers. Taking the new star velocity
+        // applies the star acceleration (indirect term) too; in the
+        // heliocentric frame the star stays at rest and the frame's is applied.
+        double acceleration[3] = { -frame[0], -frame[1], -frame[2] };
+        double clearance;
+        bool close = AddFarPull(&step, start, acceleration, &clearance);
+
+        double state[6];
+        for (int k = 0; k < 3; k++) {
+            state[k] = start[k];
+            state[3 + k] = velocity[k] - centerVelocity[k] + acceleration[k] * step.dt;
+        }
+
+        // Drift: Kepler orbit, or the whole close motion if a perturber is near
+        if (!close) {
+            double kick[3] = { state[3], state[4], state[5] };
+            keplerDrift(state, state + 3, step.mu, step.dt);
+            double moved[3] = { state[0] - start[0], state[1] - start[1], state[2] - start[2] };
+            if (getLength(moved) >= clearance && PassesClose(&step, start, state)) {
+                memcpy(state, start, sizeof(start));
+                memcpy(state + 3, kick, sizeof(kick));
+                close = true;
+            }
+        }
+        if (close) {
+            IntegrateEncounter(&step, state);
+        }
+
+        for (int k = 0; k < 3; k++) {
+            position[k] = centerEnd[k] + state[k];
+            velocity[k] = centerVelocity[k] + state[3 + k];
+        }
+        storeState(sim, i, position, velocity);
+    }
+}
+
+/**
+ * @brief Scratch bytes of a step: planets, other stars and the black hole
+ */
+size_t getHybridBytes(int systemBodies) {
+    return sizeof(Perturber) * (systemBodies + 1);
+}
+
+/**
+ * @brief Advances a two-body orbit (state relative to the central mass) by
+ * dt with universal variables. Works for elliptic and hyperbolic orbits.
+ */
+void keplerDrift(double position[3], double velocity[3], double mu, double dt) {
+    double r0[3] = { position[0], position[1], position[2] };
+    double v0[3] = { velocity[0], velocity[1], velocity[2] };
+    double r0Length = getLength(r0);
+    if (r0Length <= 0.0 || mu <= 0.0) return;
+
+    double v0Sq = v0[0] * v0[0] + v0[1] * v0[1] + v0[2] * v0[2];
+    double radialSpeed = (r0[0] * v0[0] + r0[1] * v0[1] + r0[2] * v0[2]) / r0Length;
+    double sqrtMu = sqrt(mu);
+    double alpha = 2.0 / r0Length - v0Sq / mu; // Inverse semi-major axis
+
+    // Newton iteration on the universal anomaly, from its value for a
+    // straight path (drifts are short next to the period)
+    double chi = sqrtMu * dt / r0Length;
+    double c, s;
+    for (int i = 0; i < KEPLER_MAX_ITERATIONS; i++) {
+        double z = alpha * chi * chi;
+        GetStumpff(z, &c, &s);
+
+        double f = r0Length * radialSpeed / sqrtMu * chi * chi * c +
+            (1.0 - alpha * r0Length) * chi * chi * chi * s + r0Length * chi - sqrtMu * dt;
+        double df = r0Length * radialSpeed / sqrtMu * chi * (1.0 - z * s) +
+            (1.0 - alpha * r0Length) * chi * chi * c + r0Length;
+        double delta = f / df;
+        chi -= delta;
+        if (fabs(delta) < 1E-9 * (fabs(chi) + 1.0)) break;
+    }
+    GetStumpff(alpha * chi * chi, &c, &s);
+
+    // Lagrange coefficients
+    double f = 1.0 - chi * chi / r0Length * c;
+    double g = dt - chi * chi * chi / sqrtMu * s;
+    for (int k = 0; k < 3; k++) position[k] = f * r0[k] + g * v0[k];
+    double rLength = getLength(position);
+
+    double df = sqrtMu / (rLength * r0Length) * (alpha * chi * chi * chi * s - chi);
+    double dg = 1.0 - chi * chi / rLength * c;
+    for (int k = 0; k < 3; k++) velocity[k] = df * r0[k] + dg * v0[k];
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Fills the perturbers of this step: alive system bodies but the
+ * central star, and the black hole. Each moved in a straight line with its
+ * new velocity, so its start is recovered from its end.
+ */
+static int getPerturbers(const OrbitalSim* sim, Perturber* perturbers) {
+    const OrbitalBody* bodies = sim->bodies;
+    double dt = sim->timeStep;
+    double centerStart[3] = {
+        bodies[0].position.x - (double)bodies[0].velocity.x * dt,
+        bodies[0].position.y - (double)bodies[0].velocity.y * dt,
+        bodies[0].position.z - (double)bodies[0].velocity.z * dt
+    };
+    double centerVelocity[3] = { bodies[0].velocity.x, bodies[0].velocity.y, bodies[0].velocity.z };
+
+    int count = 0;
+    for (int j = 1; j <= sim->systemBodies; j++) {
+        Vector3 position, velocity;
+        double mass, radius;
+        if (j < sim->systemBodies) {
+            if (!bodies[j].isAlive) continue;
+            position = bodies[j].position;
+            velocity = bodies[j].velocity;
+            mass = bodies[j].mass;
+            radius = sim->metadata[j].radius;
+        }
+        else {
+            if (!sim->blackHole.isActive) continue;
+            position = sim->blackHole.position;
+            velocity = sim->blackHole.velocity;
+            mass = sim->blackHole.mass;
+            radius = sim->blackHole.radius;
+        }
+
+        Perturber* perturber = &perturbers[count++];
+        double end[3] = { position.x, position.y, position.z };
+        double speed[3] = { velocity.x, velocity.y, velocity.z };
+        for (int k = 0; k < 3; k++) {
+            perturber->velocity[k] = speed[k] - centerVelocity[k];
+            perturber->position[k] = end[k] - speed[k] * dt - centerStart[k];
+        }
+        perturber->mu = GRAVITATIONAL_CONSTANT * mass;
+        perturber->radius = radius;
+        perturber->changeover = GetChangeoverRadius(mass, dt);
+        perturber->reach = getLength(perturber->velocity) * dt;
+    }
+    return count;
+}
+
+/**
+ * @brief State of a body in double: the float state plus its compensation
+ * (when the simulation carries one)
+ */
+static void loadState(const OrbitalSim* sim, int index, double position[3], double velocity[3]) {
+    const OrbitalBody* body = &sim->bodies[index];
+    position[0] = body->position.x;
+    position[1] = body->position.y;
+    position[2] = body->position.z;
+    velocity[0] = body->velocity.x;
+    velocity[1] = body->velocity.y;
+    velocity[2] = body->velocity.z;
+    if (!sim->compensation) return;
+
+    const Compensation* error = &sim->compensation[index];
+    position[0] += error->position.x;
+    position[1] += error->position.y;
+    position[2] += error->position.z;
+    velocity[0] += error->velocity.x;
+    velocity[1] += error->velocity.y;
+    velocity[2] += error->velocity.z;
+}
+
+/**
+ * @brief Rounds a double state to the float state of a body, keeping what
+ * the rounding dropped as its compensation (a double-float split)
+ */
+static void storeState(OrbitalSim* sim, int index, const double position[3], const double velocity[3]) {
+    OrbitalBody* body = &sim->bodies[index];
+    body->position = { (float)position[0], (float)position[1], (float)position[2] };
+    body->velocity = { (float)velocity[0], (float)velocity[1], (float)velocity[2] };
+    if (!sim->compensation) return;
+
+    Compensation* error = &sim->compensation[index];
+    error->position = { (float)(position[0] - body->position.x), (float)(position[1] - body->position.y),
+        (float)(position[2] - body->position.z) };
+    error->velocity = { (float)(velocity[0] - body->velocity.x), (float)(velocity[1] - body->velocity.y),
+        (float)(velocity[2] - body->velocity.z) };
+}
+
+/**
+ * @brief Distance below which a perturber is integrated with the asteroid:
+ * where one step is no longer a small fraction of the dynamical time
+ * sqrt(r^3 / GM) around it. Farther away the kicks resolve its pull, even
+ * inside its Hill sphere or where it pulls harder than the star.
+ */
+static double GetChangeoverRadius(double mass, double dt) {
+    double span = HYBRID_CHANGEOVER_STEPS * dt;
+    return cbrt(GRAVITATIONAL_CONSTANT * mass * span * span);
+}
+
+/**
+ * @brief Fraction of a pull that goes into the kick: 1 beyond the
+ * changeover radius, 0 inside its inner fraction, smooth (C2) in between
+ */
+static double GetChangeover(double distance, double radius) {
+    double inner = HYBRID_INNER_FRACTION * radius;
+    if (distance >= radius) return 1.0;
+    if (distance <= inner) return 0.0;
+
+    double x = (distance - inner) / (radius - inner);
+    return x * x * x * (10.0 + x * (-15.0 + 6.0 * x));
+}
+
+/**
+ * @brief Adds the far part of every perturber pull at the start of the step.
+ * Returns true if the asteroid is inside a changeover radius. Clearance: the
+ * asteroid cannot reach a changeover sphere during the step unless it moves
+ * at least this far.
+ */
+static bool AddFarPull(const HybridStep* step, const double position[3], double acceleration[3], double* clearance) {
+    bool close = false;
+    *clearance = INFINITY;
+    for (int p = 0; p < step->count; p++) {
+        const Perturber* perturber = &step->perturbers[p];
+        double separation[3] = {
+            position[0] - perturber->position[0],
+            position[1] - perturber->position[1],
+            position[2] - perturber->position[2]
+        };
+        double distance = getLength(separation);
+        double weight = GetChangeover(distance, perturber->changeover);
+        if (weight < 1.0) close = true;
+        AddPull(perturber, separation, distance, weight, acceleration);
+
+        double gap = distance - perturber->changeover - perturber->reach;
+        if (gap < *clearance) *clearance = gap;
+    }
+    return close;
+}
+
+/**
+ * @brief Adds weight times the pull of a perturber at a separation (of the
+ * given length) from it
+ */
+static void AddPull(const Perturber* perturber, const double separation[3], double distance,
+    double weight, double acceleration[3]) {
+    if (weight <= 0.0) return;
+
+    double reach = (distance > perturber->radius) ? distance : perturber->radius;
+    double factor = -weight * perturber->mu / (reach * reach * reach);
+    for (int k = 0; k < 3; k++) acceleration[k] += factor * separation[k];
+}
+
+/**
+ * @brief True when the straight path from start to end comes within a
+ * changeover radius of the path of a perturber. Catches the asteroids that
+ * cross a changeover sphere during a step (fast flybys).
+ */
+static bool PassesClose(const HybridStep* step, const double start[3], const double end[3]) {
+    for (int p = 0; p < step->count; p++) {
+        const Perturber* perturber = &step->perturbers[p];
+        double from[3], path[3];
+        for (int k = 0; k < 3; k++) {
+            from[k] = start[k] - perturber->position[k];
+            path[k] = end[k] - perturber->velocity[k] * step->dt - perturber->position[k] - from[k];
+        }
+
+        // Squared distance at the closest point of the path, without roots
+        double fromSq = from[0] * from[0] + from[1] * from[1] + from[2] * from[2];
+        double pathSq = path[0] * path[0] + path[1] * path[1] + path[2] * path[2];
+        double along = -(from[0] * path[0] + from[1] * path[1] + from[2] * path[2]);
+        double closestSq = fromSq;
+        if (along >= pathSq) closestSq = fromSq - 2.0 * along + pathSq; // Closest at the end
+        else if (along > 0.0) closestSq = fromSq - along * along / pathSq;
+
+        if (closestSq < perturber->changeover * perturber->changeover) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Integrates the star pull and the close part of the perturber pulls
+ * over the step, with adaptive Bulirsch-Stoer substeps
+ */
+static void IntegrateEncounter(const HybridStep* step, double state[6]) {
+    double t = 0.0;
+    double h = step->dt;
+    while (true) {
+        bool last = (h >= step->dt - t);
+        if (last) h = step->dt - t;
+
+        double result[6];
+        int columns = BulirschStoerStep(step, t, h, state, result);
+        if (columns == 0 && h > HYBRID_MIN_SUBSTEP * step->dt) {
+            h *= 0.5;
+            continue;
+        }
+
+        memcpy(state, result, sizeof(result));
+        if (last) return;
+        t += h;
+        if (columns > 0 && columns <= HYBRID_MAX_COLUMNS / 2) h *= 2.0; // Converged early
+    }
+}
+
+/**
+ * @brief One Bulirsch-Stoer substep of length h: modified midpoint
+ * integrations with more and more substeps, extrapolated to zero substep
+ * length. Returns the columns used, or 0 if it did not converge (result
+ * then holds the last extrapolation).
+ */
+static int BulirschStoerStep(const HybridStep* step, double t, double h, const double state[6], double result[6]) {
+    double derivative[6];
+    GetDerivative(step, t, state, derivative);
+
+    double previous[HYBRID_MAX_COLUMNS][6];
+    double row[HYBRID_MAX_COLUMNS][6];
+    for (int k = 0; k < HYBRID_MAX_COLUMNS; k++) {
+        int substeps = 2 * (k + 1);
+        ModifiedMidpoint(step, t, h, substeps, state, derivative, row[0]);
+
+        // Richardson extrapolation in h^2
+        for (int j = 1; j <= k; j++) {
+            double ratio = (double)substeps / (2 * (k - j + 1));
+            double factor = 1.0 / (ratio * ratio - 1.0);
+            for (int m = 0; m < 6; m++) {
+                row[j][m] = row[j - 1][m] + (row[j - 1][m] - previous[j - 1][m]) * factor;
+            }
+        }
+        memcpy(result, row[k], sizeof(row[k]));
+
+        if (k > 0) {
+            double positionError[3], velocityError[3];
+            for (int m = 0; m < 3; m++) {
+                positionError[m] = row[k][m] - row[k - 1][m];
+                velocityError[m] = row[k][3 + m] - row[k - 1][3 + m];
+            }
+            double error = getLength(positionError) / (getLength(row[k]) + 1.0) +
+                getLength(velocityError) / (getLength(row[k] + 3) + 1.0);
+            if (error < HYBRID_TOLERANCE) return k + 1;
+        }
+        memcpy(previous, row, sizeof(row));
+    }
+    return 0;
+}
+
+/**
+ * @brief Modified midpoint integration over h with the given substeps,
+ * starting from state with its derivative
+ */
+static void ModifiedMidpoint(const HybridStep* step, double t, double h, int substeps,
+    const double state[6], const double derivative[6], double result[6]) {
+    double sub = h / substeps;
+    double previous[6], current[6], slope[6];
+    for (int m = 0; m < 6; m++) {
+        previous[m] = state[m];
+        current[m] = state[m] + sub * derivative[m];
+    }
+
+    for (int n = 1; n < substeps; n++) {
+        GetDerivative(step, t + n * sub, current, slope);
+        for (int m = 0; m < 6; m++) {
+            double next = previous[m] + 2.0 * sub * slope[m];
+            previous[m] = current[m];
+            current[m] = next;
+        }
+    }
+
+    GetDerivative(step, t + h, current, slope);
+    for (int m = 0; m < 6; m++) {
+        result[m] = 0.5 * (current[m] + previous[m] + sub * slope[m]);
+    }
+}
+
+/**
+ * @brief Time derivative of an asteroid state (relative to the star) at t
+ * into the step: star pull plus the close part of the perturber pulls
+ */
+static void GetDerivative(const HybridStep* step, double t, const double state[6], double derivative[6]) {
+    double distance = getLength(state);
+    double reach = (distance > step->radius) ? distance : step->radius;
+    double factor = -step->mu / (reach * reach * reach);
+    for (int k = 0; k < 3; k++) {
+        derivative[k] = state[3 + k];
+        derivative[3 + k] = factor * state[k];
+    }
+
+    for (int p = 0; p < step->count; p++) {
+        const Perturber* perturber = &step->perturbers[p];
+        double separation[3];
+        for (int k = 0; k < 3; k++) {
+            separation[k] = state[k] - perturber->position[k] - perturber->velocity[k] * t;
+        }
+        double distance = getLength(separation);
+        double weight = 1.0 - GetChangeover(distance, perturber->changeover);
+        AddPull(perturber, separation, distance, weight, derivative + 3);
+    }
+}
+
+/**
+ * @brief Stumpff functions C(z) and S(z), with their series near z = 0
+ */
+static void GetStumpff(double z, double* c, double* s) {
+    if (z > 1E-3) {
+        double root = sqrt(z);
+        *c = (1.0 - cos(root)) / z;
+        *s = (root - sin(root)) / (root * root * root);
+    }
+    else if (z < -1E-3) {
+        double root = sqrt(-z);
+        *c = (cosh(root) - 1.0) / -z;
+        *s = (sinh(root) - root) / (root * root * root);
+    }
+    else {
+        *c = 1.0 / 2.0 - z / 24.0 + z * z / 720.0;
+        *s = 1.0 / 6.0 - z / 120.0 + z * z / 5040.0;
+    }
+}
+
+static double getLength(const double v[3]) {
+    return sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
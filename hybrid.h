@@ -0,0 +1,21 @@
+/**
+ * @brief Implements the hybrid symplectic integrator of the asteroids
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef HYBRID_H
+#define HYBRID_H
+
+#include <stddef.h>
+
+struct OrbitalSim;
+
+void advanceHybridBodies(OrbitalSim* sim, int begin, int end);
+size_t getHybridBytes(int systemBodies);
+
+// Two-body orbit (state relative to the central mass) advanced by dt
+void keplerDrift(double position[3], double velocity[3], double mu, double dt);
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * @brief Implements the run-time choice of the physics kernels
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * The widest build of physicsKernels.cpp that both the binary and the CPU
+ * have is picked when a simulation is constructed, so one binary runs on
+ * every x86-64 machine of the fleet. SimConfig.isa can lower the choice to
+ * compare builds or to reproduce results across machines.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include "physicsKernels.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Widest instruction set this CPU (and the operating system, which
+ * must save the wider registers) supports
+ */
+IsaLevel getCpuIsaLevel(void) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+        __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512bw")) {
+        return ISA_LEVEL_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return ISA_LEVEL_AVX2;
+    }
+    return ISA_LEVEL_SSE2;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!fma || !osxsave || !avx) return ISA_LEVEL_SSE2;
+
+    unsigned long long enabled = _xgetbv(0);
+    if ((enabled & 0x06) != 0x06) return ISA_LEVEL_SSE2; // XMM and YMM state
+
+    __cpuidex(info, 7, 0);
+    if (!(info[1] & (1 << 5))) return ISA_LEVEL_SSE2; // AVX2
+
+    // F, DQ, BW and VL, with the opmask and ZMM state
+    unsigned int avx512 = (1u << 16) | (1u << 17) | (1u << 30) | (1u << 31);
+    if (((unsigned int)info[1] & avx512) == avx512 && (enabled & 0xE0) == 0xE0) {
+        return ISA_LEVEL_AVX512;
+    }
+    return ISA_LEVEL_AVX2;
+#else
+    return ISA_LEVEL_SSE2; // Only the baseline build exists
+#endif
+}
+
+/**
+ * @brief Widest build not wider than requested (ISA_LEVEL_AUTO: no limit)
+ * that the binary has and the CPU runs
+ */
+const PhysicsKernels* selectPhysicsKernels(IsaLevel requested) {
+    const PhysicsKernels* builds[] = { NULL, getSse2Kernels(), getAvx2Kernels(), getAvx512Kernels() };
+
+    int level = getCpuIsaLevel();
+    if (requested != ISA_LEVEL_AUTO && requested < level) {
+        level = requested;
+    }
+    while (level > ISA_LEVEL_SSE2 && !builds[level]) {
+        level--;
+    }
+    return builds[level];
+}
+
+/**
+ * @brief Name of an instruction set, as the --isa option takes it
+ */
+const char* getIsaLevelName(IsaLevel level) {
+    switch (level) {
+    case ISA_LEVEL_SSE2:   return "sse2";
+    case ISA_LEVEL_AVX2:   return "avx2";
+    case ISA_LEVEL_AVX512: return "avx512";
+    default:               return "auto";
+    }
+}
@@ -5,12 +5,29 @@
  * @copyright Copyright (c) 2025
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "distributed.h"
+#include "eventLog.h"
+#include "forces.h"
+#include "memoryStats.h"
+#include "metrics.h"
 #include "orbitalSim.h"
+#include "parallel.h"
+#include "parareal.h"
+#include "physicsKernels.h"
+#include "sharedState.h"
+#include "telemetry.h"
 #include "view.h"
+#include "raymath.h"
 
 #define SECONDS_PER_DAY 86400
+#define CAMERA_FOCUS_RATIO 0.5F // Physics focus radius / camera-target distance
 
-int main() {
+int main(int argc, char* argv[]) {
     int fps = 60;
     float timeMultiplier = 5 * SECONDS_PER_DAY; // Simulation speed: 5 days per simulation second
     float timeStep = timeMultiplier / fps;
@@ -20,20 +37,314 @@ int main() {
         SYSTEM_TYPE_SOLAR,      // Solar system
         EASTER_EGG_NONE,        // No easter egg
         DISPERSION_NORMAL,      // Normal asteroid dispersion
-        1000                    // 1000 asteroids
+        1000,                   // 1000 asteroids
+        false,                  // Regular pages
+        1,                      // Every asteroid every step
+        0,                      // No ring particles
+        false,                  // Bodies pass through each other
+        0.0f,                   // No close approach tracking
+        false,                  // Every asteroid with the same integrator
+        0,                      // Newtonian gravity only
+        FRAME_EPHEMERIS,        // Positions in the ephemeris frame
+        false,                  // Plain float state
+        false,                  // Exact inverse square roots
+        ISA_LEVEL_AUTO          // Widest instruction set of the CPU
     };
 
+    // Command line options
+    float pararealDays = 0.0f;
+    PararealConfig pararealConfig = getDefaultPararealConfig();
+    const char* sharedStateName = NULL;
+    int localWorkers = 0;
+    int threads = 0;
+    bool numa = false;
+    const char* workerEndpoints = NULL;
+    int telemetryPort = 0;
+    float telemetryRate = 10.0f;
+    int telemetryBodies = 2000;
+    const char* metricsPath = NULL;
+    float metricsInterval = 5.0f;
+    const char* eventLogPath = NULL;
+    const char* fateTablePath = NULL;
+    const char* approachTablePath = NULL;
+    float memoryLimit = 0.0f;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--parareal") && i + 1 < argc) {
+            pararealDays = (float)atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--parareal-slices") && i + 1 < argc) {
+            pararealConfig.slices = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--shm") && i + 1 < argc) {
+            sharedStateName = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--workers") && i + 1 < argc) {
+            localWorkers = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--connect") && i + 1 < argc) {
+            workerEndpoints = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--telemetry") && i + 1 < argc) {
+            telemetryPort = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--telemetry-rate") && i + 1 < argc) {
+            telemetryRate = (float)atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--telemetry-bodies") && i + 1 < argc) {
+            telemetryBodies = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--metrics-file") && i + 1 < argc) {
+            metricsPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--metrics-interval") && i + 1 < argc) {
+            metricsInterval = (float)atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--event-log") && i + 1 < argc) {
+            eventLogPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--fates") && i + 1 < argc) {
+            fateTablePath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--numa")) {
+            numa = true;
+        }
+        else if (!strcmp(argv[i], "--memory-limit") && i + 1 < argc) {
+            memoryLimit = (float)atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--drift-steps") && i + 1 < argc) {
+            defaultConfig.driftSteps = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--encounters") && i + 1 < argc) {
+            defaultConfig.encounterHillRadii = (float)atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--approaches") && i + 1 < argc) {
+            approachTablePath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--collisions")) {
+            defaultConfig.collisions = true;
+        }
+        else if (!strcmp(argv[i], "--hybrid")) {
+            defaultConfig.hybrid = true;
+        }
+        else if (!strcmp(argv[i], "--compensated")) {
+            defaultConfig.compensated = true;
+        }
+        else if (!strcmp(argv[i], "--fast-rsqrt")) {
+            defaultConfig.fastInverseSqrt = true;
+        }
+        else if (!strcmp(argv[i], "--isa") && i + 1 < argc) {
+            i++;
+            defaultConfig.isa = !strcmp(argv[i], "sse2") ? ISA_LEVEL_SSE2 :
+                !strcmp(argv[i], "avx2") ? ISA_LEVEL_AVX2 :
+                !strcmp(argv[i], "avx512") ? ISA_LEVEL_AVX512 : ISA_LEVEL_AUTO;
+        }
+        else if (!strcmp(argv[i], "--frame") && i + 1 < argc) {
+            i++;
+            defaultConfig.frame = !strcmp(argv[i], "heliocentric") ? FRAME_HELIOCENTRIC : FRAME_EPHEMERIS;
+        }
+        else if (!strcmp(argv[i], "--forces") && i + 1 < argc) {
+            const char* terms = argv[++i];
+            if (strstr(terms, "relativity")) defaultConfig.forceTerms |= FORCE_TERM_RELATIVITY;
+            if (strstr(terms, "oblateness")) defaultConfig.forceTerms |= FORCE_TERM_OBLATENESS;
+            if (strstr(terms, "radiation")) defaultConfig.forceTerms |= FORCE_TERM_RADIATION;
+        }
+        else if (!strcmp(argv[i], "--rings") && i + 1 < argc) {
+            defaultConfig.ringParticles = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--huge-pages")) {
+            defaultConfig.hugePages = true;
+        }
+        else if (!strcmp(argv[i], "--worker") && i + 1 < argc) {
+            return runDistributedWorker(argv[++i]);
+        }
+        else {
+            printf("Usage: %s [--parareal DAYS] [--parareal-slices N] [--shm NAME]\n"
+                "       [--workers N | --connect HOST:PORT,...] [--worker [ADDRESS:]PORT]\n"
+                "       [--telemetry PORT] [--telemetry-rate HZ] [--telemetry-bodies N]\n"
+                "       [--metrics-file PATH] [--metrics-interval SECONDS]\n"
+                "       [--event-log PATH] [--fates PATH] [--huge-pages]\n"
+                "       [--threads N] [--numa] [--memory-limit MB] [--drift-steps N]\n"
+                "       [--rings N] [--collisions] [--encounters HILL_RADII]\n"
+                "       [--approaches PATH] [--hybrid]\n"
+                "       [--forces relativity,oblateness,radiation] [--frame ephemeris|heliocentric]\n"
+                "       [--compensated] [--fast-rsqrt] [--isa auto|sse2|avx2|avx512]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Binary event log, started first so every event is captured
+    if (eventLogPath) {
+        startEventLog(eventLogPath);
+    }
+
+    if (memoryLimit > 0.0f) {
+        setMemoryLimit((size_t)(memoryLimit * 1024 * 1024));
+    }
+
+    // Worker processes only see their own slice
+    if (defaultConfig.collisions && (workerEndpoints || localWorkers > 0)) {
+        printf("Collisions: not available with worker processes, disabled\n");
+        defaultConfig.collisions = false;
+    }
+    if (defaultConfig.encounterHillRadii > 0.0f && (workerEndpoints || localWorkers > 0)) {
+        printf("Encounters: not available with worker processes, disabled\n");
+        defaultConfig.encounterHillRadii = 0.0f;
+    }
+    if (defaultConfig.hybrid && (workerEndpoints || localWorkers > 0)) {
+        printf("Hybrid integrator: not available with worker processes, disabled\n");
+        defaultConfig.hybrid = false;
+    }
+    if (defaultConfig.frame == FRAME_HELIOCENTRIC && (workerEndpoints || localWorkers > 0)) {
+        printf("Heliocentric frame: not available with worker processes, disabled\n");
+        defaultConfig.frame = FRAME_EPHEMERIS;
+    }
+
     OrbitalSim* sim = constructOrbitalSim(timeStep, &defaultConfig);
+    if (!sim) {
+        printf("Cannot allocate the simulation\n");
+        stopEventLog();
+        return 1;
+    }
+    if (defaultConfig.isa != ISA_LEVEL_AUTO && sim->kernels->isa != defaultConfig.isa) {
+        printf("Physics kernels: %s not available on this machine, using %s\n",
+            getIsaLevelName(defaultConfig.isa), getIsaLevelName(sim->kernels->isa));
+    }
+
+    // Long horizon: advance in parallel-in-time before opening the view
+    if (pararealDays > 0.0f) {
+        int steps = (int)(pararealDays * SECONDS_PER_DAY / timeStep);
+        PararealStats stats;
+        if (pararealOrbitalSim(sim, steps, &pararealConfig, &stats)) {
+            printf("Parareal: %d steps, %d slices, %d iterations, residual %g (%s)\n",
+                steps, stats.slices, stats.iterations, stats.residual,
+                stats.converged ? "converged" : (stats.iterations == stats.slices) ?
+                "not converged, serial result without speedup" : "not converged");
+        }
+        logFateEvents(sim->fateEvents, sim->fateEventCount);
+    }
+
+    // Asteroid slices owned by worker processes (before the window is created)
+    DistributedSim* dist = NULL;
+    if (workerEndpoints) {
+        dist = connectDistributedSim(sim, workerEndpoints);
+    }
+    else if (localWorkers > 0) {
+        dist = constructDistributedSim(sim, localWorkers, numa);
+    }
+
+    // Asteroid ranges owned by threads of this process
+    ParallelSim* parallel = NULL;
+    if (!dist && threads > 0) {
+        parallel = constructParallelSim(sim, threads, numa);
+    }
+
+    // Publish state for external readers
+    SharedState* sharedState = NULL;
+    if (sharedStateName) {
+        sharedState = constructSharedState(sharedStateName, sim->numBodies);
+    }
+
+    // Loopback telemetry endpoint
+    TelemetryServer* telemetry = NULL;
+    if (telemetryPort > 0) {
+        telemetry = constructTelemetryServer(telemetryPort, telemetryRate, telemetryBodies);
+    }
+
+    // Prometheus text file for node_exporter style scrapers
+    if (metricsPath) {
+        startMetricsFile(metricsPath, metricsInterval);
+    }
+
     View* view = constructView(fps);
+    TelemetryStats stats = {};
+    int exitCode = 0;
 
     while (isViewRendering(view)) {
-        for (int i = 0; i < UPDATEPERFRAME; i++) // Accelerates simulation 
-            updateOrbitalSim(sim);
+        std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+        // Asteroids close to the camera (relative to the zoom) get every step
+        Vector3 eye = view->camera.position;
+        float focusRadius = CAMERA_FOCUS_RATIO * Vector3Distance(eye, view->camera.target);
+        setOrbitalSimFocus(sim, Vector3Scale(eye, 1.0F / SCALE_FACTOR), focusRadius / SCALE_FACTOR);
+
+        bool workerLost = false;
+        for (int i = 0; i < UPDATEPERFRAME && !workerLost; i++) { // Accelerates simulation 
+            if (parallel) {
+                updateParallelSim(parallel);
+            }
+            else if (!dist) {
+                updateOrbitalSim(sim);
+            }
+            else if (!updateDistributedSim(dist)) {
+                workerLost = true;
+                continue;
+            }
+
+            // Accretions and ejections of this step (replays were logged before)
+            if (!isReplayedStep(sim)) logFateEvents(&sim->fateEvents[sim->stepEventBegin], sim->fateEventCount - sim->stepEventBegin);
+        }
+        if (dist && !workerLost) {
+            workerLost = !syncDistributedSim(dist);
+        }
+
+        // The simulation is back at the last sync, unless a slice was lost
+        if (workerLost) {
+            bool stateLost = dist->stateLost;
+            int lostWorker = dist->lostWorker;
+            logEvent(EVENT_WORKER_LOST, (uint32_t)lostWorker, sim->time, 0.0, 0.0);
+            destroyDistributedSim(dist);
+            dist = NULL;
+            if (stateLost) {
+                printf("Distributed: worker %d lost while sending its asteroids, cannot continue\n", lostWorker);
+                exitCode = 1;
+                break;
+            }
+            printf("Distributed: worker %d lost, continuing in this process\n", lostWorker);
+        }
+
+        updateRenderSnapshot(view->snapshot, sim, view->camera.position);
+
+        std::chrono::steady_clock::time_point physicsEnd = std::chrono::steady_clock::now();
+        if (sharedState)
+            publishSharedState(sharedState, sim);
         renderView(view, sim, 0);
+
+        // Profiler figures for external observers
+        std::chrono::steady_clock::time_point renderEnd = std::chrono::steady_clock::now();
+        stats.fps = (float)GetFPS();
+        stats.physicsMs = std::chrono::duration<float, std::milli>(physicsEnd - frameStart).count();
+        stats.renderMs = std::chrono::duration<float, std::milli>(renderEnd - physicsEnd).count();
+        stats.renderedPlanets = view->renderedPlanets;
+        stats.renderedAsteroids = view->renderedAsteroids;
+        if (telemetry)
+            publishTelemetry(telemetry, sim, &stats);
+
+        addMetric(METRIC_FRAMES, 1);
+        addMetric(METRIC_PHASE_RENDER_SECONDS, stats.renderMs / 1000.0);
+        observeFrameTime(std::chrono::duration<double>(renderEnd - frameStart).count());
+        setMetric(METRIC_ALIVE_BODIES, sim->aliveBodies);
+        setMetric(METRIC_TOTAL_BODIES, sim->numBodies);
+        setMetric(METRIC_DRIFT_BODIES, sim->driftBodies);
+        setMetric(METRIC_FPS, stats.fps);
+        updateMetricRates();
     }
 
+    stopMetricsFile();
+    if (fateTablePath)
+        writeFateTable(sim, fateTablePath);
+    if (approachTablePath)
+        writeApproachTable(sim, approachTablePath);
     destroyView(view);
+    destroyTelemetryServer(telemetry);
+    destroySharedState(sharedState);
+    destroyDistributedSim(dist);
+    destroyParallelSim(parallel);
     destroyOrbitalSim(sim);
+    stopEventLog();
 
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
@@ -0,0 +1,126 @@
+/**
+ * @brief Implements memory usage accounting per subsystem
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdio.h>
+#include <atomic>
+
+#include "memoryStats.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+static std::atomic<long long> memoryUsage[MEMORY_SUBSYSTEM_COUNT];
+static std::atomic<size_t> memoryLimit(0);
+
+static const char* memorySubsystemNames[MEMORY_SUBSYSTEM_COUNT] = {
+    "bodies",
+    "scratch",
+    "spatial_index",
+    "snapshots",
+    "output_buffers",
+    "gpu_buffers",
+    "assets"
+};
+
+/**
+ * @brief Adds (or, with a negative value, releases) bytes of a subsystem
+ */
+void addMemoryUsage(MemorySubsystem subsystem, long long bytes) {
+    if (bytes != 0) memoryUsage[subsystem].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Bytes currently reported by a subsystem
+ */
+size_t getMemoryUsage(MemorySubsystem subsystem) {
+    long long bytes = memoryUsage[subsystem].load(std::memory_order_relaxed);
+    return (bytes > 0) ? (size_t)bytes : 0;
+}
+
+/**
+ * @brief Bytes currently reported by every subsystem
+ */
+size_t getTotalMemoryUsage(void) {
+    size_t total = 0;
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+        total += getMemoryUsage((MemorySubsystem)i);
+    }
+    return total;
+}
+
+/**
+ * @brief Short lowercase name (used as a metrics label)
+ */
+const char* getMemorySubsystemName(MemorySubsystem subsystem) {
+    return memorySubsystemNames[subsystem];
+}
+
+/**
+ * @brief Replaces what an owner reported for a subsystem
+ */
+void setAccountedMemory(MemoryAccount* account, MemorySubsystem subsystem, size_t bytes) {
+    addMemoryUsage(subsystem, (long long)bytes - (long long)account->bytes[subsystem]);
+    account->bytes[subsystem] = bytes;
+}
+
+/**
+ * @brief Releases everything an owner reported
+ */
+void releaseAccountedMemory(MemoryAccount* account) {
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+        setAccountedMemory(account, (MemorySubsystem)i, 0);
+    }
+}
+
+/**
+ * @brief Sets the limit that fitsMemoryLimit checks against (0 = unlimited)
+ */
+void setMemoryLimit(size_t bytes) {
+    memoryLimit.store(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Current limit (0 = unlimited)
+ */
+size_t getMemoryLimit(void) {
+    return memoryLimit.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Would the total stay within the limit after growing by extraBytes?
+ */
+bool fitsMemoryLimit(size_t extraBytes) {
+    size_t limit = getMemoryLimit();
+    return limit == 0 || getTotalMemoryUsage() + extraBytes <= limit;
+}
+
+/**
+ * @brief Physical memory available to new allocations (0 if unknown). On
+ * Linux this includes reclaimable page cache (MemAvailable).
+ */
+size_t getAvailableMemory(void) {
+#ifdef __linux__
+    FILE* file = fopen("/proc/meminfo", "r");
+    if (file) {
+        char line[128];
+        unsigned long long kilobytes = 0;
+        while (fgets(line, sizeof(line), file)) {
+            if (sscanf(line, "MemAvailable: %llu kB", &kilobytes) == 1) break;
+        }
+        fclose(file);
+        if (kilobytes > 0) return (size_t)kilobytes * 1024;
+    }
+#endif
+
+#if !defined(_WIN32) && defined(_SC_AVPHYS_PAGES)
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0) return (size_t)pages * (size_t)pageSize;
+#endif
+    return 0;
+}
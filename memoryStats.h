@@ -0,0 +1,52 @@
+/**
+ * @brief Implements memory usage accounting per subsystem
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <stddef.h>
+
+/**
+ * @brief Where the bytes go
+ */
+typedef enum {
+    MEMORY_BODIES,          // Body and metadata arrays
+    MEMORY_SCRATCH,         // Per-step scratch (accelerations)
+    MEMORY_SPATIAL_INDEX,   // Neighbour search structures
+    MEMORY_SNAPSHOTS,       // Render, telemetry and shared memory copies of the state
+    MEMORY_OUTPUT_BUFFERS,  // Event rings and fate history
+    MEMORY_GPU_BUFFERS,     // Vertex and index data uploaded to the GPU (estimated)
+    MEMORY_ASSETS,          // CPU copies of loaded models
+    MEMORY_SUBSYSTEM_COUNT
+} MemorySubsystem;
+
+/**
+ * @brief What one owner has reported, so it can update or release it
+ */
+struct MemoryAccount {
+    size_t bytes[MEMORY_SUBSYSTEM_COUNT];
+};
+
+// Global counters (thread safe)
+void addMemoryUsage(MemorySubsystem subsystem, long long bytes);
+size_t getMemoryUsage(MemorySubsystem subsystem);
+size_t getTotalMemoryUsage(void);
+const char* getMemorySubsystemName(MemorySubsystem subsystem);
+
+// Owner accounts: report the current size, the delta goes to the counters
+void setAccountedMemory(MemoryAccount* account, MemorySubsystem subsystem, size_t bytes);
+void releaseAccountedMemory(MemoryAccount* account);
+
+// Limit on the total (0 = unlimited)
+void setMemoryLimit(size_t bytes);
+size_t getMemoryLimit(void);
+bool fitsMemoryLimit(size_t extraBytes);
+
+// Physical memory the system can still hand out (0 if unknown)
+size_t getAvailableMemory(void);
+
+#endif
@@ -0,0 +1,404 @@
+/**
+ * @brief Implements lock-free simulation metrics in Prometheus text format
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "memoryStats.h"
+#include "metrics.h"
+
+#define METRICS_HISTOGRAM_BUCKETS 64
+#define METRICS_HISTOGRAM_BASE 1E-4 // Upper bound of the first bucket [s]
+#define METRICS_BUCKETS_PER_OCTAVE 4
+#define METRICS_FILE_BUFFER 16384
+#define SECONDS_PER_DAY 86400.0
+
+/**
+ * @brief Counters owned by one thread. Only the owner writes them (load+store,
+ * no read-modify-write); exporters read them concurrently.
+ */
+struct MetricsBlock {
+    std::atomic<double> counters[METRIC_COUNTER_COUNT];
+    std::atomic<uint64_t> frameBuckets[METRICS_HISTOGRAM_BUCKETS];
+    std::atomic<double> frameSum;
+    std::atomic<bool> inUse;
+    MetricsBlock* next;
+};
+
+/**
+ * @brief Releases the thread block when its thread exits (totals are kept)
+ */
+struct MetricsBlockOwner {
+    MetricsBlock* block;
+    ~MetricsBlockOwner() {
+        if (block) block->inUse.store(false, std::memory_order_release);
+    }
+};
+
+/**
+ * @brief Description of an exported counter
+ */
+struct MetricDescription {
+    const char* name;
+    const char* labels;
+    const char* help;
+};
+
+static const MetricDescription counterDescriptions[METRIC_COUNTER_COUNT] = {
+    { "orbitalsim_steps_total", "", "Simulation timesteps computed" },
+    { "orbitalsim_simulated_seconds_total", "", "Simulated time advanced" },
+    { "orbitalsim_accretion_events_total", "", "Bodies swallowed by the black hole" },
+    { "orbitalsim_allocations_total", "", "Heap allocations made by the simulation" },
+    { "orbitalsim_allocated_bytes_total", "", "Bytes requested by simulation allocations" },
+    { "orbitalsim_frames_total", "", "Frames rendered" },
+    { "orbitalsim_phase_seconds_total", "{phase=\"system\"}", "Wall time spent per step phase" },
+    { "orbitalsim_phase_seconds_total", "{phase=\"asteroids\"}", NULL },
+    { "orbitalsim_phase_seconds_total", "{phase=\"advance\"}", NULL },
+    { "orbitalsim_phase_seconds_total", "{phase=\"render\"}", NULL },
+    { "orbitalsim_collision_events_total", "", "Bodies absorbed in collisions" },
+    { "orbitalsim_close_approaches_total", "", "Close approaches of asteroids to planets" },
+    { "orbitalsim_parareal_extra_steps_total", "", "Parareal timesteps not part of the accepted trajectory" },
+};
+
+static const MetricDescription gaugeDescriptions[METRIC_GAUGE_COUNT] = {
+    { "orbitalsim_alive_bodies", "", "Bodies not swallowed yet" },
+    { "orbitalsim_bodies", "", "Bodies in the simulation" },
+    { "orbitalsim_drift_bodies", "", "Asteroids updated by Kepler drift every few steps" },
+    { "orbitalsim_steps_per_second", "", "Timesteps per wall clock second" },
+    { "orbitalsim_simulated_days_per_second", "", "Simulated days per wall clock second" },
+    { "orbitalsim_fps", "", "Rendered frames per second" },
+    { "orbitalsim_step_fixed_seconds", "", "Measured step cost independent of the body count" },
+    { "orbitalsim_step_seconds_per_body", "", "Measured step cost per body" },
+    { "orbitalsim_render_seconds_per_body", "", "Measured render cost per body and frame" },
+};
+
+static std::atomic<MetricsBlock*> metricsBlocks(NULL);
+static std::atomic<double> metricsGauges[METRIC_GAUGE_COUNT];
+static thread_local MetricsBlockOwner metricsOwner = { NULL };
+
+// Rate bookkeeping (main thread)
+static double rateLastTime = 0.0;
+static double rateLastSteps = 0.0;
+static double rateLastSimulated = 0.0;
+static double rateLastSystem = 0.0;
+static double rateLastBodyPhases = 0.0;
+static double rateLastFrames = 0.0;
+static double rateLastRender = 0.0;
+
+// Metrics file writer
+static std::thread fileThread;
+static std::mutex fileLock;
+static std::condition_variable fileWake;
+static bool fileRunning = false;
+
+static MetricsBlock* getThreadBlock(void);
+static double sumCounter(MetricCounter counter);
+static double getFrameQuantile(const uint64_t* buckets, uint64_t total, double quantile);
+static double getBucketBound(int bucket);
+static void runMetricsFile(char* path, float interval);
+
+/**
+ * @brief Adds to a counter of the calling thread
+ */
+void addMetric(MetricCounter counter, double value) {
+    MetricsBlock* block = getThreadBlock();
+    if (!block) return;
+
+    std::atomic<double>& slot = block->counters[counter];
+    slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Sets a gauge
+ */
+void setMetric(MetricGauge gauge, double value) {
+    metricsGauges[gauge].store(value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Records a frame time in the log-bucketed histogram
+ */
+void observeFrameTime(double seconds) {
+    MetricsBlock* block = getThreadBlock();
+    if (!block) return;
+
+    int bucket = 0;
+    if (seconds > METRICS_HISTOGRAM_BASE) {
+        bucket = (int)ceil(METRICS_BUCKETS_PER_OCTAVE * log2(seconds / METRICS_HISTOGRAM_BASE));
+        if (bucket >= METRICS_HISTOGRAM_BUCKETS) bucket = METRICS_HISTOGRAM_BUCKETS - 1;
+    }
+
+    std::atomic<uint64_t>& slot = block->frameBuckets[bucket];
+    slot.store(slot.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    block->frameSum.store(block->frameSum.load(std::memory_order_relaxed) + seconds, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Monotonic clock in seconds, for phase timings
+ */
+double getMetricsTime(void) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Refreshes the steps/s and simulated days/s gauges about once a
+ * second, and the step and render costs from the phase timings of the
+ * same window (per body of METRIC_TOTAL_BODIES)
+ */
+void updateMetricRates(void) {
+    double now = getMetricsTime();
+    double elapsed = now - rateLastTime;
+    if (elapsed < 1.0) return;
+
+    double steps = sumCounter(METRIC_STEPS);
+    double simulated = sumCounter(METRIC_SIMULATED_SECONDS);
+    double system = sumCounter(METRIC_PHASE_SYSTEM_SECONDS);
+    double bodyPhases = sumCounter(METRIC_PHASE_ASTEROIDS_SECONDS) + sumCounter(METRIC_PHASE_ADVANCE_SECONDS);
+    double frames = sumCounter(METRIC_FRAMES);
+    double render = sumCounter(METRIC_PHASE_RENDER_SECONDS);
+    double bodies = getMetric(METRIC_TOTAL_BODIES);
+
+    if (rateLastTime > 0.0) {
+        double windowSteps = steps - rateLastSteps;
+        double windowFrames = frames - rateLastFrames;
+
+        setMetric(METRIC_STEPS_PER_SECOND, windowSteps / elapsed);
+        setMetric(METRIC_SIMULATED_DAYS_PER_SECOND, (simulated - rateLastSimulated) / SECONDS_PER_DAY / elapsed);
+
+        if (windowSteps > 0.0 && bodies > 0.0) {
+            setMetric(METRIC_STEP_FIXED_SECONDS, (system - rateLastSystem) / windowSteps);
+            setMetric(METRIC_STEP_SECONDS_PER_BODY, (bodyPhases - rateLastBodyPhases) / (windowSteps * bodies));
+        }
+        if (windowFrames > 0.0 && bodies > 0.0) {
+            setMetric(METRIC_RENDER_SECONDS_PER_BODY, (render - rateLastRender) / (windowFrames * bodies));
+        }
+    }
+
+    rateLastTime = now;
+    rateLastSteps = steps;
+    rateLastSimulated = simulated;
+    rateLastSystem = system;
+    rateLastBodyPhases = bodyPhases;
+    rateLastFrames = frames;
+    rateLastRender = render;
+}
+
+/**
+ * @brief Last value of a gauge
+ */
+double getMetric(MetricGauge gauge) {
+    return metricsGauges[gauge].load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Predicts steps/s and FPS for a body count from the measured costs
+ * (both scale linearly with the bodies). Returns false until there is a
+ * measurement.
+ */
+bool forecastThroughput(int bodies, int stepsPerFrame, double maxFps, ThroughputForecast* forecast) {
+    double perBody = getMetric(METRIC_STEP_SECONDS_PER_BODY);
+    if (perBody <= 0.0) return false;
+
+    forecast->stepSeconds = getMetric(METRIC_STEP_FIXED_SECONDS) + perBody * bodies;
+    double frameSeconds = stepsPerFrame * forecast->stepSeconds + getMetric(METRIC_RENDER_SECONDS_PER_BODY) * bodies;
+
+    forecast->fps = (frameSeconds > 0.0) ? 1.0 / frameSeconds : maxFps;
+    if (maxFps > 0.0 && forecast->fps > maxFps) forecast->fps = maxFps;
+    forecast->stepsPerSecond = stepsPerFrame * forecast->fps;
+    return true;
+}
+
+/**
+ * @brief Writes every metric in Prometheus text exposition format.
+ * Returns the length written (truncated output is still NUL terminated).
+ */
+int formatMetrics(char* buffer, int size) {
+    int length = 0;
+#define METRICS_PRINT(...) \
+    if (length < size) length += snprintf(buffer + length, size - length, __VA_ARGS__)
+
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        const MetricDescription* description = &counterDescriptions[i];
+        if (description->help) {
+            METRICS_PRINT("# HELP %s %s\n# TYPE %s counter\n", description->name, description->help, description->name);
+        }
+        METRICS_PRINT("%s%s %.9g\n", description->name, description->labels, sumCounter((MetricCounter)i));
+    }
+
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        const MetricDescription* description = &gaugeDescriptions[i];
+        METRICS_PRINT("# HELP %s %s\n# TYPE %s gauge\n", description->name, description->help, description->name);
+        METRICS_PRINT("%s %.9g\n", description->name, metricsGauges[i].load(std::memory_order_relaxed));
+    }
+
+    // Frame time percentiles from the merged histograms
+    uint64_t buckets[METRICS_HISTOGRAM_BUCKETS] = { 0 };
+    uint64_t total = 0;
+    double sum = 0.0;
+    for (MetricsBlock* block = metricsBlocks.load(std::memory_order_acquire); block; block = block->next) {
+        for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) {
+            uint64_t count = block->frameBuckets[i].load(std::memory_order_relaxed);
+            buckets[i] += count;
+            total += count;
+        }
+        sum += block->frameSum.load(std::memory_order_relaxed);
+    }
+
+    METRICS_PRINT("# HELP orbitalsim_frame_time_seconds Wall time per rendered frame\n");
+    METRICS_PRINT("# TYPE orbitalsim_frame_time_seconds summary\n");
+    const double quantiles[] = { 0.5, 0.9, 0.99 };
+    for (int i = 0; i < 3; i++) {
+        METRICS_PRINT("orbitalsim_frame_time_seconds{quantile=\"%g\"} %.6g\n", quantiles[i],
+            getFrameQuantile(buckets, total, quantiles[i]));
+    }
+    METRICS_PRINT("orbitalsim_frame_time_seconds_sum %.9g\n", sum);
+    METRICS_PRINT("orbitalsim_frame_time_seconds_count %llu\n", (unsigned long long)total);
+
+    METRICS_PRINT("# HELP orbitalsim_memory_bytes Bytes in use per subsystem\n");
+    METRICS_PRINT("# TYPE orbitalsim_memory_bytes gauge\n");
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+        METRICS_PRINT("orbitalsim_memory_bytes{subsystem=\"%s\"} %zu\n",
+            getMemorySubsystemName((MemorySubsystem)i), getMemoryUsage((MemorySubsystem)i));
+    }
+
+#undef METRICS_PRINT
+    return (length < size) ? length : size - 1;
+}
+
+/**
+ * @brief Starts a background thread that rewrites a metrics file atomically
+ * (write to path.tmp, then rename) every interval seconds
+ */
+bool startMetricsFile(const char* path, float interval) {
+    if (!path || interval <= 0.0f || fileRunning) return false;
+
+    char* pathCopy = (char*)malloc(strlen(path) + 1);
+    if (!pathCopy) return false;
+    strcpy(pathCopy, path);
+
+    fileRunning = true;
+    fileThread = std::thread(runMetricsFile, pathCopy, interval);
+    return true;
+}
+
+/**
+ * @brief Stops the metrics file thread after a final write
+ */
+void stopMetricsFile(void) {
+    {
+        std::lock_guard<std::mutex> guard(fileLock);
+        if (!fileRunning) return;
+        fileRunning = false;
+    }
+    fileWake.notify_all();
+    fileThread.join();
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Returns the calling thread block, claiming a free one or adding one
+ */
+static MetricsBlock* getThreadBlock(void) {
+    if (metricsOwner.block) return metricsOwner.block;
+
+    for (MetricsBlock* block = metricsBlocks.load(std::memory_order_acquire); block; block = block->next) {
+        bool expected = false;
+        if (block->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            metricsOwner.block = block;
+            return block;
+        }
+    }
+
+    MetricsBlock* block = new MetricsBlock();
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) block->counters[i].store(0.0);
+    for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) block->frameBuckets[i].store(0);
+    block->frameSum.store(0.0);
+    block->inUse.store(true);
+
+    // Lock-free push; blocks are never removed so readers can walk the list
+    MetricsBlock* head = metricsBlocks.load(std::memory_order_relaxed);
+    do {
+        block->next = head;
+    } while (!metricsBlocks.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+
+    metricsOwner.block = block;
+    return block;
+}
+
+/**
+ * @brief Total of a counter over every thread block
+ */
+static double sumCounter(MetricCounter counter) {
+    double total = 0.0;
+    for (MetricsBlock* block = metricsBlocks.load(std::memory_order_acquire); block; block = block->next) {
+        total += block->counters[counter].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * @brief Upper bound of the histogram bucket holding a quantile
+ */
+static double getFrameQuantile(const uint64_t* buckets, uint64_t total, double quantile) {
+    if (total == 0) return 0.0;
+
+    uint64_t rank = (uint64_t)ceil(quantile * total);
+    uint64_t cumulative = 0;
+    for (int i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) {
+        cumulative += buckets[i];
+        if (cumulative >= rank) return getBucketBound(i);
+    }
+    return getBucketBound(METRICS_HISTOGRAM_BUCKETS - 1);
+}
+
+/**
+ * @brief Bucket i holds times up to base * 2^(i / bucketsPerOctave)
+ */
+static double getBucketBound(int bucket) {
+    return METRICS_HISTOGRAM_BASE * pow(2.0, (double)bucket / METRICS_BUCKETS_PER_OCTAVE);
+}
+
+/**
+ * @brief Metrics file thread
+ */
+static void runMetricsFile(char* path, float interval) {
+    char* buffer = (char*)malloc(METRICS_FILE_BUFFER);
+    char* temporary = (char*)malloc(strlen(path) + 5);
+    if (buffer && temporary) {
+        sprintf(temporary, "%s.tmp", path);
+
+        bool running = true;
+        while (running) {
+            {
+                std::unique_lock<std::mutex> guard(fileLock);
+                fileWake.wait_for(guard, std::chrono::duration<float>(interval), [] { return !fileRunning; });
+                running = fileRunning;
+            }
+
+            int length = formatMetrics(buffer, METRICS_FILE_BUFFER);
+            FILE* file = fopen(temporary, "w");
+            if (file) {
+                fwrite(buffer, 1, length, file);
+                fclose(file);
+                rename(temporary, path);
+            }
+        }
+    }
+
+    free(temporary);
+    free(buffer);
+    free(path);
+}
@@ -0,0 +1,72 @@
+/**
+ * @brief Implements lock-free simulation metrics in Prometheus text format
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+/**
+ * @brief Monotonic counters (summed over every thread that touched them)
+ */
+typedef enum {
+    METRIC_STEPS,
+    METRIC_SIMULATED_SECONDS,
+    METRIC_ACCRETIONS,
+    METRIC_ALLOCATIONS,
+    METRIC_ALLOCATED_BYTES,
+    METRIC_FRAMES,
+    METRIC_PHASE_SYSTEM_SECONDS,
+    METRIC_PHASE_ASTEROIDS_SECONDS,
+    METRIC_PHASE_ADVANCE_SECONDS,
+    METRIC_PHASE_RENDER_SECONDS,
+    METRIC_COLLISIONS,
+    METRIC_CLOSE_APPROACHES,
+    METRIC_PARAREAL_EXTRA_STEPS,      // Fine steps Parareal repeated beyond the accepted trajectory
+    METRIC_COUNTER_COUNT
+} MetricCounter;
+
+/**
+ * @brief Last-value gauges
+ */
+typedef enum {
+    METRIC_ALIVE_BODIES,
+    METRIC_TOTAL_BODIES,
+    METRIC_DRIFT_BODIES,              // Asteroids in the drift tier
+    METRIC_STEPS_PER_SECOND,
+    METRIC_SIMULATED_DAYS_PER_SECOND,
+    METRIC_FPS,
+    METRIC_STEP_FIXED_SECONDS,        // Step cost independent of the body count
+    METRIC_STEP_SECONDS_PER_BODY,     // Step cost per body
+    METRIC_RENDER_SECONDS_PER_BODY,   // Frame render cost per body
+    METRIC_GAUGE_COUNT
+} MetricGauge;
+
+/**
+ * @brief Predicted throughput for a body count
+ */
+struct ThroughputForecast {
+    double stepSeconds;
+    double stepsPerSecond;
+    double fps;
+};
+
+// Recording (hot path: relaxed stores to a per-thread block, no locks)
+void addMetric(MetricCounter counter, double value);
+void setMetric(MetricGauge gauge, double value);
+void observeFrameTime(double seconds);
+double getMetricsTime(void);
+
+// Derived gauges (steps/s, simulated days/s, costs), call once per frame
+void updateMetricRates(void);
+double getMetric(MetricGauge gauge);
+bool forecastThroughput(int bodies, int stepsPerFrame, double maxFps, ThroughputForecast* forecast);
+
+// Export
+int formatMetrics(char* buffer, int size);
+bool startMetricsFile(const char* path, float interval);
+void stopMetricsFile(void);
+
+#endif
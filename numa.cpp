@@ -0,0 +1,129 @@
+/**
+ * @brief Implements NUMA node discovery and memory placement helpers
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * Uses sysfs and raw system calls so libnuma is not required.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "numa.h"
+
+#define NUMA_MAX_NODES 64
+#define NUMA_POLICY_PREFERRED 1  // MPOL_PREFERRED
+#define NUMA_MOVE_PAGES (1 << 1) // MPOL_MF_MOVE
+
+#ifdef __linux__
+
+static bool readCpuList(int node, cpu_set_t* cpus);
+
+/**
+ * @brief Number of online NUMA nodes (1 when unknown)
+ */
+int getNumaNodeCount(void) {
+    FILE* file = fopen("/sys/devices/system/node/online", "r");
+    if (!file) return 1;
+
+    // Format: "0" or "0-3" or "0,2-3"; the highest node id is what matters
+    int last = 0;
+    int first;
+    while (fscanf(file, "%d", &first) == 1) {
+        last = first;
+        int separator = fgetc(file);
+        if (separator == '-' && fscanf(file, "%d", &last) == 1) {
+            separator = fgetc(file);
+        }
+        if (separator != ',') break;
+    }
+    fclose(file);
+
+    return (last + 1 < NUMA_MAX_NODES) ? last + 1 : NUMA_MAX_NODES;
+}
+
+/**
+ * @brief Runs the calling thread on the CPUs of a node and makes the node
+ * preferred for the memory it touches first
+ */
+bool bindToNumaNode(int node) {
+    if (node < 0 || node >= NUMA_MAX_NODES) return false;
+
+    cpu_set_t cpus;
+    if (!readCpuList(node, &cpus) || sched_setaffinity(0, sizeof(cpus), &cpus) != 0) return false;
+
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_set_mempolicy, NUMA_POLICY_PREFERRED, &mask, NUMA_MAX_NODES + 1) == 0;
+}
+
+/**
+ * @brief Migrates the pages of a range (rounded out to whole pages) to a node
+ */
+bool moveToNumaNode(void* address, size_t size, int node) {
+    if (!address || size == 0 || node < 0 || node >= NUMA_MAX_NODES) return false;
+
+    uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t begin = (uintptr_t)address & ~(pageSize - 1);
+    uintptr_t end = ((uintptr_t)address + size + pageSize - 1) & ~(pageSize - 1);
+
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_mbind, (void*)begin, end - begin, NUMA_POLICY_PREFERRED,
+        &mask, NUMA_MAX_NODES + 1, NUMA_MOVE_PAGES) == 0;
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Parses /sys/devices/system/node/nodeN/cpulist ("0-7,16-23")
+ */
+static bool readCpuList(int node, cpu_set_t* cpus) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    CPU_ZERO(cpus);
+    int first;
+    while (fscanf(file, "%d", &first) == 1) {
+        int last = first;
+        int separator = fgetc(file);
+        if (separator == '-' && fscanf(file, "%d", &last) == 1) {
+            separator = fgetc(file);
+        }
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, cpus);
+        }
+        if (separator != ',') break;
+    }
+    fclose(file);
+
+    return CPU_COUNT(cpus) > 0;
+}
+
+#else
+
+// NUMA placement is only implemented on Linux
+
+int getNumaNodeCount(void) {
+    return 1;
+}
+
+bool bindToNumaNode(int node) {
+    return false;
+}
+
+bool moveToNumaNode(void* address, size_t size, int node) {
+    return false;
+}
+
+#endif
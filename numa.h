@@ -0,0 +1,17 @@
+/**
+ * @brief Implements NUMA node discovery and memory placement helpers
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <stddef.h>
+
+int getNumaNodeCount(void);
+bool bindToNumaNode(int node);
+bool moveToNumaNode(void* address, size_t size, int node);
+
+#endif
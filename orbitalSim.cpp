@@ -8,59 +8,138 @@
 #define _USE_MATH_DEFINES
 #define GRAVITATIONAL_CONSTANT 6.6743E-11F
 #define ASTEROIDS_MEAN_RADIUS 4E11F
+#define EJECTION_DISTANCE 5E13F // ~330 AU from the central body
+#define ARENA_MIN_CAPACITY (4 * 1024 * 1024)
+#define STAR_MIN_MASS 1E29F // ~50 Jupiter masses
+#define BLACK_HOLE_GROWTH_RATE 1E3F
+#define PROGRESS_INTERVAL 4096 // Asteroids between progress reports
+#define DRIFT_MIN_CENTER_DISTANCE 5E10F // Closer to the star asteroids always get every step
+#define DRIFT_TIDAL_LIMIT 1E-4 // Black hole tide / star pull above which an asteroid is perturbed
+#define DRIFT_MARGIN 2.0F // Safety factor on the distance covered between updates
+#define SUBSTEP_ORBIT_FRACTION 0.1 // Substep / dynamical time sqrt(r^3 / GM) of the innermost satellite
+#define SATELLITE_MIN_DISTANCE_CUBED 1E21 // Softening of satellite pulls (1E7 m)
 
 #include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "orbitalSim.h"
 #include "ephemerides.h"
+#include "eventLog.h"
+#include "forces.h"
+#include "hybrid.h"
+#include "metrics.h"
+#include "physicsKernels.h"
+#include "softening.h"
 
 static float getRandomFloat(float min, float max);
 static void configureAsteroid(OrbitalBody* body, float centerMass, DispersionType dispersion, int index);
-static void ComputeGravitationalAccelerations(OrbitalSim* sim, OrbitalBody* bodies, Vector3* accelerations, int n);
-static void ComputeBlackHoleAcceleration(BlackHole* blackHole, OrbitalBody* bodies, Vector3* accelerations, int n);
-static void HandleBlackHoleCollision(BlackHole* blackHole, OrbitalBody* body, int n);
+template <class StarTerm>
+static void ComputeSystemAccelerations(OrbitalSim* sim, OrbitalBody* bodies, Vector3* accelerations);
+static int HandleBlackHoleCollision(OrbitalSim* sim, int begin, int end);
+static void DetectEjections(OrbitalSim* sim, int begin, int end);
+static void RecordFate(OrbitalSim* sim, int body, BodyFate fate, float relativeSpeed, int target);
+static void AccreteMass(OrbitalSim* sim, double mass, int count);
+static void IntegrateBodies(OrbitalBody* bodies, const Vector3* accelerations, int begin, int end, float dt,
+    Vector3 frameAcceleration, Compensation* compensation);
+static Vector3 AddCompensated(Vector3 sum, Vector3 increment, Vector3* error);
+static void MergeBodies(OrbitalSim* sim, int survivor, int absorbed);
+static int compareCollisions(const void* a, const void* b);
+static bool CanDrift(const OrbitalSim* sim);
+static void AdvanceDriftTier(OrbitalSim* sim, int begin, int end);
+static void DriftBody(OrbitalSim* sim, int index, long long fromStep, long long toStep);
+static void ShiftEulerVelocity(OrbitalSim* sim, int index, float sign);
+static bool IsUnperturbed(const OrbitalSim* sim, int index, float span);
+static void KeplerDrift(Vector3* position, Vector3* velocity, double mu, double dt);
+static void CatchUpDriftBodies(OrbitalSim* sim, long long lastStep);
+static void ComputeSatelliteTides(OrbitalSim* sim);
+static void AddTidalPull(double* tide, Vector3 toSource, Vector3 satellite, double mass);
+template <class PlanetTerm>
+static void AdvanceSubsystems(OrbitalSim* sim);
+static void AdvanceRings(OrbitalSim* sim);
+static bool allocateBodies(OrbitalSim* sim, const SimConfig* config);
+static void setBodyMetadata(OrbitalSim* sim, int index, const EphemeridesBody* body);
 static void initializeSolarSystem(OrbitalSim* sim);
 static void initializeAlphaCentauriSystem(OrbitalSim* sim);
-static void initializeAsteroids(OrbitalSim* sim, int count, DispersionType dispersion);
+static void initializeSatellites(OrbitalSim* sim, const EphemeridesBody* bodies, const EphemeridesMoon* moons, int count);
+static void initializeRings(OrbitalSim* sim, const EphemeridesRing* rings);
+static void copyRingFrame(RingSystem* dst, const RingSystem* src);
+static void initializeAsteroids(OrbitalSim* sim, int count, DispersionType dispersion,
+    SimProgressCallback progress, void* context);
+static void centerOnStar(OrbitalSim* sim);
+static void applyEasterEgg(OrbitalSim* sim);
 
 void createBlackHole(OrbitalSim* sim, Vector3 position) {
 	if (sim->blackHole.isActive) return; // There can be only one
+    // Drift bodies would ignore the black hole until their next slot
+    CatchUpDriftBodies(sim, llround(sim->time / sim->timeStep) - 1);
     sim->blackHole.position = position;
     sim->blackHole.velocity = { 0.0f, 0.0f, 0.0f };
 	sim->blackHole.mass = 10.0f * 1.989E30f; // Aproximately 10 solar masses
-    sim->blackHole.eventHorizonRadius = 2.95f * (sim->blackHole.mass / 1.989E30f) * 1E6f; // Schwarzschild ratio
-    sim->blackHole.radius = 200.0f * sim->blackHole.eventHorizonRadius;
+    sim->blackHoleMetadata.eventHorizonRadius = 2.95f * (sim->blackHole.mass / 1.989E30f) * 1E6f; // Schwarzschild ratio
+    sim->blackHole.radius = 200.0f * sim->blackHoleMetadata.eventHorizonRadius;
     sim->blackHole.isActive = true;
-	sim->blackHole.growthRate = 1E3f; // Grows by consuming mass
+	sim->blackHoleMetadata.growthRate = BLACK_HOLE_GROWTH_RATE; // Grows by consuming mass
 	sim->blackHole.acceleration = { 0.0f, 0.0f, 0.0f };
+
+    // Checks scheduled without the black hole may come too late
+    if (sim->encounters) restartEncounterTracker(sim->encounters);
+
+    logEvent(EVENT_BLACK_HOLE_CREATED, 0, sim->time, sim->blackHole.mass, 0.0);
 }
 
 /**
  * @brief Constructs an orbital simulation with configurable parameters
  */
 OrbitalSim* constructOrbitalSim(float timeStep, const SimConfig* config) {
+    return buildOrbitalSim(timeStep, config, NULL, NULL);
+}
+
+/**
+ * @brief Constructs an orbital simulation reporting progress while the
+ * asteroids are generated (progress may be NULL)
+ */
+OrbitalSim* buildOrbitalSim(float timeStep, const SimConfig* config, SimProgressCallback progress, void* context) {
     OrbitalSim* sim = (OrbitalSim*)malloc(sizeof(OrbitalSim));
     if (!sim) return NULL;
 
     sim->timeStep = timeStep;
     sim->config = *config; // Store configuration
+    sim->kernels = selectPhysicsKernels(config->isa);
     sim->asteroidCount = config->asteroidCount;
 
     // Determine system bodies count
-    sim->systemBodies = (config->systemType == SYSTEM_TYPE_SOLAR) ? SOLARSYSTEM_BODYNUM : ALPHACENTAURISYSTEM_BODYNUM;
+    sim->systemBodies = getSystemBodyCount(config->systemType);
     sim->numBodies = sim->systemBodies + sim->asteroidCount;
 
     // Allocate memory for all bodies
-    sim->bodies = (OrbitalBody*)malloc(sizeof(OrbitalBody) * sim->numBodies);
-    if (!sim->bodies) {
+    sim->arena = NULL;
+    memset(&sim->memory, 0, sizeof(sim->memory));
+    if (!allocateBodies(sim, config)) {
+        destroyArena(sim->arena);
         free(sim);
         return NULL;
     }
 
     sim->blackHole.isActive = false;
+    sim->blackHoleMetadata.eventHorizonRadius = 0.0;
+    sim->blackHoleMetadata.growthRate = BLACK_HOLE_GROWTH_RATE;
     sim->aliveBodies = sim->numBodies;
+    sim->time = 0.0;
+    sim->generation = 0;
+    sim->isTrial = false;
+    sim->replayedTime = 0.0;
+    sim->fateEvents = NULL;
+    sim->fateEventCount = 0;
+    sim->fateEventCapacity = 0;
+    sim->stepEventBegin = 0;
+    sim->focusPosition = { 0.0f, 0.0f, 0.0f };
+    sim->focusRadius = 0.0f;
+    sim->driftBodies = 0;
+    sim->frameOrigin = { 0.0f, 0.0f, 0.0f };
+    sim->frameVelocity = { 0.0f, 0.0f, 0.0f };
+    sim->frameAcceleration = { 0.0f, 0.0f, 0.0f };
 
     // Initialize system
     if (config->systemType == SYSTEM_TYPE_SOLAR) {
@@ -72,42 +151,74 @@ OrbitalSim* constructOrbitalSim(float timeStep, const SimConfig* config) {
 
     // Initialize asteroids if any
     if (sim->asteroidCount > 0) {
-        initializeAsteroids(sim, sim->asteroidCount, config->dispersion);
+        initializeAsteroids(sim, sim->asteroidCount, config->dispersion, progress, context);
+    }
+    if (config->frame == FRAME_HELIOCENTRIC) {
+        centerOnStar(sim);
     }
 
+    sim->encounters = (config->encounterHillRadii > 0.0f) ? constructEncounterTracker(sim) : NULL;
+    if (progress) progress(context, 1.0f);
     return sim;
 }
 
 /**
- * @brief Resets the orbital simulation with new configuration
+ * @brief Swaps a freshly built simulation into sim in O(1) and destroys the
+ * old state. Pointers to sim stay valid; the swap counts as a reset.
  */
-void resetOrbitalSim(OrbitalSim* sim, const SimConfig* config) {
-    if (!sim) return;
+void replaceOrbitalSim(OrbitalSim* sim, OrbitalSim* replacement) {
+    OrbitalSim old = *sim;
+
+    *sim = *replacement;
+    sim->timeStep = old.timeStep;
+    sim->generation = old.generation + 1;
+    sim->focusPosition = old.focusPosition;
+    sim->focusRadius = old.focusRadius;
+    applyEasterEgg(sim); // As resetOrbitalSim does
+    logEvent(EVENT_RESET, (uint32_t)sim->numBodies, 0.0, sim->generation, 0.0);
+
+    *replacement = old;
+    destroyOrbitalSim(replacement);
+}
+
+/**
+ * @brief Resets the orbital simulation with new configuration. Returns false,
+ * keeping the current simulation untouched, if the new bodies do not fit in
+ * memory (or in the memory limit).
+ */
+bool resetOrbitalSim(OrbitalSim* sim, const SimConfig* config) {
+    if (!sim) return false;
+
+    // Reuse the arena (old bodies are released in O(1))
+    int systemBodies = getSystemBodyCount(config->systemType);
+    if (!allocateBodies(sim, config)) {
+        printf("Reset: keeping the current simulation\n");
+        return false;
+    }
 
     // Store old values
     float timeStep = sim->timeStep;
 
-    // Free old bodies array
-    if (sim->bodies) {
-        free(sim->bodies);
-    }
-
     // Reset black hole
     sim->blackHole.isActive = false;
 
     // Update configuration
     sim->config = *config;
+    sim->kernels = selectPhysicsKernels(config->isa);
     sim->asteroidCount = config->asteroidCount;
-    sim->systemBodies = (config->systemType == SYSTEM_TYPE_SOLAR) ? SOLARSYSTEM_BODYNUM : ALPHACENTAURISYSTEM_BODYNUM;
+    sim->systemBodies = systemBodies;
     sim->numBodies = sim->systemBodies + sim->asteroidCount;
     sim->timeStep = timeStep;
-
-    // Allocate new memory
-    sim->bodies = (OrbitalBody*)malloc(sizeof(OrbitalBody) * sim->numBodies);
-    if (!sim->bodies) {
-        sim->numBodies = 0;
-        return;
-    }
+    sim->time = 0.0;
+    sim->generation++;
+    sim->replayedTime = 0.0;
+    sim->fateEventCount = 0;
+    sim->stepEventBegin = 0;
+    sim->driftBodies = 0;
+    sim->frameOrigin = { 0.0f, 0.0f, 0.0f };
+    sim->frameVelocity = { 0.0f, 0.0f, 0.0f };
+    sim->frameAcceleration = { 0.0f, 0.0f, 0.0f };
+    logEvent(EVENT_RESET, (uint32_t)sim->numBodies, 0.0, sim->generation, 0.0);
 
     sim->aliveBodies = sim->numBodies;
 
@@ -121,15 +232,33 @@ void resetOrbitalSim(OrbitalSim* sim, const SimConfig* config) {
 
     // Initialize asteroids if any
     if (sim->asteroidCount > 0) {
-        initializeAsteroids(sim, sim->asteroidCount, config->dispersion);
+        initializeAsteroids(sim, sim->asteroidCount, config->dispersion, NULL, NULL);
     }
-
-    if (config->easterEgg == EASTER_EGG_JUPITER_1000X)
-    {
-        if (sim->config.systemType == SYSTEM_TYPE_SOLAR && sim->numBodies > 5) {
-            sim->bodies[5].mass *= 1000.0;
-        }
+    if (config->frame == FRAME_HELIOCENTRIC) {
+        centerOnStar(sim);
     }
+
+    destroyEncounterTracker(sim->encounters);
+    sim->encounters = (config->encounterHillRadii > 0.0f) ? constructEncounterTracker(sim) : NULL;
+
+    applyEasterEgg(sim);
+    return true;
+}
+
+/**
+ * @brief Bytes a simulation with this configuration needs (bodies, metadata,
+ * step scratch and collision index)
+ */
+size_t getOrbitalSimBytes(const SimConfig* config) {
+    int bodies = getSystemBodyCount(config->systemType) + config->asteroidCount;
+    int satellites = getSystemSatelliteCount(config->systemType);
+    return (sizeof(OrbitalBody) + sizeof(BodyMetadata) + sizeof(Vector3)) * (size_t)bodies +
+        (sizeof(Satellite) + sizeof(BodyMetadata) + sizeof(Vector3)) * (size_t)satellites +
+        6 * sizeof(float) * (size_t)getSystemRingParticles(config) +
+        (config->compensated ? sizeof(Compensation) * (size_t)(bodies + satellites) : 0) +
+        (config->collisions ? getCollisionBytes(bodies) : 0) +
+        (config->encounterHillRadii > 0.0f ? getEncounterTrackerBytes(bodies) : 0) +
+        (config->hybrid ? getHybridBytes(getSystemBodyCount(config->systemType)) : 0);
 }
 
 /**
@@ -137,61 +266,576 @@ void resetOrbitalSim(OrbitalSim* sim, const SimConfig* config) {
  */
 void destroyOrbitalSim(OrbitalSim* sim) {
     if (!sim) return;
-    if (sim->bodies) free(sim->bodies);
+    destroyEncounterTracker(sim->encounters);
+    destroyArena(sim->arena);
+    free(sim->fateEvents);
+    releaseAccountedMemory(&sim->memory);
     free(sim);
 }
 
+/**
+ * @brief Creates an independent copy of a simulation (configuration and state)
+ */
+OrbitalSim* cloneOrbitalSim(const OrbitalSim* sim) {
+    if (!sim) return NULL;
+
+    OrbitalSim* clone = (OrbitalSim*)malloc(sizeof(OrbitalSim));
+    if (!clone) return NULL;
+
+    *clone = *sim;
+    clone->fateEvents = NULL;
+    clone->fateEventCapacity = 0;
+    clone->encounters = NULL; // Approaches are only tracked on the original
+    clone->arena = NULL;
+    memset(&clone->memory, 0, sizeof(clone->memory));
+    if (!allocateBodies(clone, &sim->config)) {
+        destroyArena(clone->arena);
+        free(clone);
+        return NULL;
+    }
+    copyRingFrame(&clone->rings, &sim->rings);
+
+    for (int i = 0; i < sim->numBodies; i++) {
+        clone->metadata[i] = sim->metadata[i];
+    }
+    for (int i = 0; i < sim->numSatellites; i++) {
+        clone->satelliteMetadata[i] = sim->satelliteMetadata[i];
+    }
+    copyOrbitalSimState(clone, sim);
+    return clone;
+}
+
+/**
+ * @brief Creates a copy of everything but the asteroids (system bodies,
+ * black hole, moons, rings, frame and time), e.g. to roll back a
+ * coordinator whose asteroids live in other processes
+ */
+OrbitalSim* cloneOrbitalSystem(const OrbitalSim* sim) {
+    if (!sim) return NULL;
+
+    OrbitalSim* clone = (OrbitalSim*)malloc(sizeof(OrbitalSim));
+    if (!clone) return NULL;
+
+    *clone = *sim;
+    clone->config.asteroidCount = 0;
+    clone->asteroidCount = 0;
+    clone->numBodies = sim->systemBodies;
+    clone->fateEvents = NULL;
+    clone->fateEventCapacity = 0;
+    clone->fateEventCount = 0;
+    clone->encounters = NULL;
+    clone->arena = NULL;
+    memset(&clone->memory, 0, sizeof(clone->memory));
+    if (!allocateBodies(clone, &clone->config)) {
+        destroyArena(clone->arena);
+        free(clone);
+        return NULL;
+    }
+    copyRingFrame(&clone->rings, &sim->rings);
+
+    for (int i = 0; i < sim->systemBodies; i++) {
+        clone->metadata[i] = sim->metadata[i];
+    }
+    for (int i = 0; i < sim->numSatellites; i++) {
+        clone->satelliteMetadata[i] = sim->satelliteMetadata[i];
+    }
+    copyOrbitalSystemState(clone, sim);
+    return clone;
+}
+
+/**
+ * @brief Copies what initializeRings sets besides the particles (allocateBodies
+ * leaves a ring without a parent)
+ */
+static void copyRingFrame(RingSystem* dst, const RingSystem* src) {
+    dst->parent = src->parent;
+    for (int i = 0; i < 3; i++) {
+        dst->axes[i] = src->axes[i];
+    }
+    dst->j2 = src->j2;
+    dst->referenceRadius = src->referenceRadius;
+    dst->innerRadius = src->innerRadius;
+    dst->color = src->color;
+}
+
+/**
+ * @brief Copies the dynamic state (bodies, black hole, time) between two
+ * simulations built from the same configuration
+ */
+bool copyOrbitalSimState(OrbitalSim* dst, const OrbitalSim* src) {
+    if (!dst || !src || dst->numBodies != src->numBodies) return false;
+
+    copyOrbitalSystemState(dst, src);
+    for (int i = src->systemBodies; i < src->numBodies; i++) {
+        dst->bodies[i] = src->bodies[i];
+    }
+    if (dst->compensation && src->compensation) {
+        memcpy(&dst->compensation[src->systemBodies], &src->compensation[src->systemBodies],
+            sizeof(Compensation) * (src->numBodies - src->systemBodies));
+    }
+    if (dst->encounters) restartEncounterTracker(dst->encounters);
+
+    // Fate history
+    if (src->fateEventCount > dst->fateEventCapacity) {
+        FateEvent* events = (FateEvent*)realloc(dst->fateEvents, sizeof(FateEvent) * src->fateEventCapacity);
+        if (!events) return false;
+        dst->fateEvents = events;
+        dst->fateEventCapacity = src->fateEventCapacity;
+        setAccountedMemory(&dst->memory, MEMORY_OUTPUT_BUFFERS, sizeof(FateEvent) * dst->fateEventCapacity);
+    }
+    for (int i = 0; i < src->fateEventCount; i++) {
+        dst->fateEvents[i] = src->fateEvents[i];
+    }
+    dst->fateEventCount = src->fateEventCount;
+    dst->stepEventBegin = src->stepEventBegin;
+    return true;
+}
+
+/**
+ * @brief Copies the state of everything but the asteroids (system bodies,
+ * black hole, moons, rings, frame, time and alive count). Fate events are
+ * left alone.
+ */
+void copyOrbitalSystemState(OrbitalSim* dst, const OrbitalSim* src) {
+    for (int i = 0; i < src->systemBodies; i++) {
+        dst->bodies[i] = src->bodies[i];
+    }
+    if (dst->compensation && src->compensation) {
+        memcpy(dst->compensation, src->compensation, sizeof(Compensation) * src->systemBodies);
+    }
+    dst->blackHole = src->blackHole;
+    dst->blackHoleMetadata = src->blackHoleMetadata;
+    dst->aliveBodies = src->aliveBodies;
+    dst->time = src->time;
+    dst->driftBodies = src->driftBodies;
+    dst->frameOrigin = src->frameOrigin;
+    dst->frameVelocity = src->frameVelocity;
+    if (dst->numSatellites == src->numSatellites) {
+        for (int i = 0; i < src->numSatellites; i++) {
+            dst->satellites[i] = src->satellites[i];
+        }
+        if (dst->satelliteCompensation && src->satelliteCompensation) {
+            memcpy(dst->satelliteCompensation, src->satelliteCompensation, sizeof(Compensation) * src->numSatellites);
+        }
+        for (int i = 0; i < src->numSubsystems; i++) {
+            dst->subsystems[i] = src->subsystems[i];
+        }
+        dst->numSubsystems = src->numSubsystems;
+    }
+    if (src->rings.count <= getSystemRingParticles(&dst->config)) {
+        RingSystem* rings = &dst->rings;
+        rings->count = src->rings.count; // Dropped when the parent is swallowed
+        for (int i = 0; i < src->rings.count; i++) {
+            rings->x[i] = src->rings.x[i];
+            rings->y[i] = src->rings.y[i];
+            rings->z[i] = src->rings.z[i];
+            rings->vx[i] = src->rings.vx[i];
+            rings->vy[i] = src->rings.vy[i];
+            rings->vz[i] = src->rings.vz[i];
+        }
+        dst->rings.substeps = src->rings.substeps;
+    }
+    for (int i = 0; i <= DRIFT_MAX_STEPS; i++) {
+        dst->centerPositions[i] = src->centerPositions[i];
+        dst->centerVelocities[i] = src->centerVelocities[i];
+    }
+}
+
 /**
  * @brief Simulates a timestep
  */
 void updateOrbitalSim(OrbitalSim* sim) {
     int n = sim->numBodies;
-    float dt = sim->timeStep;
-    OrbitalBody* bodies = sim->bodies;
+    Vector3* accelerations = sim->accelerations;
+    size_t mark = markArena(sim->arena); // Hybrid and collision scratch
+
+    sim->stepEventBegin = sim->fateEventCount;
+
+    double start = getMetricsTime();
+    computeSystemAccelerations(sim, accelerations);
+    double systemEnd = getMetricsTime();
+    computeAsteroidRange(sim, accelerations, sim->systemBodies, n);
+    double asteroidsEnd = getMetricsTime();
+    advanceBlackHole(sim);
+    int accreted = advanceBodyRange(sim, accelerations, 0, n);
+    int merged = resolveCollisions(sim);
+    trackCloseApproaches(sim);
+    double advanceEnd = getMetricsTime();
+
+    sim->aliveBodies -= accreted + merged;
+    sim->time += sim->timeStep;
+    rewindArena(sim->arena, mark);
+
+    if (sim->isTrial) return; // Parareal counts the accepted trajectory itself
+    addMetric(METRIC_PHASE_SYSTEM_SECONDS, systemEnd - start);
+    addMetric(METRIC_PHASE_ASTEROIDS_SECONDS, asteroidsEnd - systemEnd);
+    addMetric(METRIC_PHASE_ADVANCE_SECONDS, advanceEnd - asteroidsEnd);
+    if (isReplayedStep(sim)) return; // Counted before the rollback
+    addMetric(METRIC_ACCRETIONS, accreted);
+    addMetric(METRIC_COLLISIONS, merged);
+    addMetric(METRIC_STEPS, 1);
+    addMetric(METRIC_SIMULATED_SECONDS, sim->timeStep);
+}
 
-    Vector3* accelerations = (Vector3*)malloc(n * sizeof(Vector3));
-    if (!accelerations) return;
+//***** STEP PHASE FUNCTIONS *****//
 
-    ComputeGravitationalAccelerations(sim, bodies, accelerations, n);
+/**
+ * @brief Phase 1: accelerations between system bodies, plus the black hole
+ * pull on them. Clears the black hole acceleration for this step and sets
+ * the frame acceleration (the star's, in the heliocentric frame).
+ */
+void computeSystemAccelerations(OrbitalSim* sim, Vector3* accelerations) {
+    if (sim->config.forceTerms & FORCE_TERM_RELATIVITY) {
+        ComputeSystemAccelerations<RelativityTerm>(sim, sim->bodies, accelerations);
+    }
+    else {
+        ComputeSystemAccelerations<NoStarTerm>(sim, sim->bodies, accelerations);
+    }
 
     if (sim->blackHole.isActive) {
         sim->blackHole.acceleration = { 0, 0, 0 };
-        ComputeBlackHoleAcceleration(&sim->blackHole, bodies, accelerations, n);
-		// Updates black hole position and velocity
-        Vector3 accBH = sim->blackHole.acceleration;
-        sim->blackHole.velocity = Vector3Add(sim->blackHole.velocity,
-            Vector3Scale(accBH, dt));
-        sim->blackHole.position = Vector3Add(sim->blackHole.position,
-            Vector3Scale(sim->blackHole.velocity, dt));
-        HandleBlackHoleCollision(&sim->blackHole, bodies, n);
-    }
-
-    for (int i = 0; i < n; i++) {
-		if (!bodies[i].isAlive) continue; // Just updates alive bodies
-        bodies[i].velocity = Vector3Add(bodies[i].velocity,
-            Vector3Scale(accelerations[i], dt));
+        sim->kernels->blackHoleAccelerations(&sim->blackHole, sim->bodies, accelerations, 0, sim->systemBodies);
+    }
 
-        bodies[i].position = Vector3Add(bodies[i].position,
-            Vector3Scale(bodies[i].velocity, dt));
+    if (sim->config.frame == FRAME_HELIOCENTRIC && sim->bodies[0].isAlive) {
+        sim->frameAcceleration = accelerations[0];
+    }
+    else {
+        sim->frameAcceleration = { 0.0f, 0.0f, 0.0f };
+    }
+
+    ComputeSatelliteTides(sim);
+}
+
+/**
+ * @brief Phase 2: accelerations on the asteroids in [begin, end). Adds their
+ * pull on the black hole to blackHole.acceleration.
+ *
+ * Asteroids are test particles: ranges can be computed independently.
+ */
+void computeAsteroidRange(OrbitalSim* sim, Vector3* accelerations, int begin, int end) {
+    sim->kernels->asteroidAccelerations(sim, accelerations, &sim->blackHole, begin, end);
+}
+
+/**
+ * @brief Phase 2 without side effects: accelerations on the asteroids in
+ * [begin, end), returning their pull on the black hole instead of adding it.
+ * Safe to call concurrently on disjoint ranges.
+ */
+Vector3 computeAsteroidPull(const OrbitalSim* sim, Vector3* accelerations, int begin, int end) {
+    BlackHole blackHole = sim->blackHole;
+    blackHole.acceleration = { 0, 0, 0 };
+    sim->kernels->asteroidAccelerations(sim, accelerations, &blackHole, begin, end);
+    return blackHole.acceleration;
+}
+
+/**
+ * @brief Phase 3: moves the black hole with its accumulated acceleration
+ */
+void advanceBlackHole(OrbitalSim* sim) {
+    if (!sim->blackHole.isActive) return;
+
+    float dt = sim->timeStep;
+    Vector3 accBH = Vector3Subtract(sim->blackHole.acceleration, sim->frameAcceleration);
+    sim->blackHole.velocity = Vector3Add(sim->blackHole.velocity,
+        Vector3Scale(accBH, dt));
+    sim->blackHole.position = Vector3Add(sim->blackHole.position,
+        Vector3Scale(sim->blackHole.velocity, dt));
+}
+
+/**
+ * @brief Phase 4: accretion, integration and ejection check of the bodies in
+ * [begin, end). Returns the number of bodies swallowed by the black hole.
+ * The hybrid integrator needs the star advanced first: only from begin 0.
+ */
+int advanceBodyRange(OrbitalSim* sim, const Vector3* accelerations, int begin, int end) {
+    int accreted = 0;
+    if (sim->blackHole.isActive) {
+        accreted = HandleBlackHoleCollision(sim, begin, end);
+    }
+
+    if (sim->config.hybrid && begin == 0 && sim->bodies[0].isAlive) {
+        int systemEnd = (end < sim->systemBodies) ? end : sim->systemBodies;
+        IntegrateBodies(sim->bodies, accelerations, begin, systemEnd, sim->timeStep, sim->frameAcceleration,
+            sim->compensation);
+        advanceHybridBodies(sim, systemEnd, end);
+    }
+    else {
+        IntegrateBodies(sim->bodies, accelerations, begin, end, sim->timeStep, sim->frameAcceleration,
+            sim->compensation);
+    }
+    if (begin == 0) {
+        // The origin moves as the star would in the ephemeris frame
+        sim->frameVelocity = Vector3Add(sim->frameVelocity, Vector3Scale(sim->frameAcceleration, sim->timeStep));
+        sim->frameOrigin = Vector3Add(sim->frameOrigin, Vector3Scale(sim->frameVelocity, sim->timeStep));
+
+        if (sim->config.forceTerms & FORCE_TERM_OBLATENESS) AdvanceSubsystems<OblatenessTerm>(sim);
+        else AdvanceSubsystems<NoPlanetTerm>(sim);
+        AdvanceRings(sim);
+    }
+    if (sim->config.driftSteps > 1) {
+        AdvanceDriftTier(sim, begin, end);
+    }
+    DetectEjections(sim, begin, end);
+    return accreted;
+}
+
+/**
+ * @brief Phase 5: merges the bodies that touched during the step, in order
+ * of contact. Needs every body, so it runs after all the ranges advanced.
+ * Returns the number of bodies absorbed.
+ */
+int resolveCollisions(OrbitalSim* sim) {
+    if (!sim->sweep.entries) return 0;
+
+    size_t mark = markArena(sim->arena);
+    Collision* collisions = (Collision*)allocateArena(sim->arena, sizeof(Collision) * MAX_COLLISIONS);
+    if (!collisions) return 0;
+
+    int count = findCollisions(sim, collisions, MAX_COLLISIONS);
+    qsort(collisions, count, sizeof(Collision), compareCollisions);
+
+    // A body absorbed earlier in the step takes no part in later contacts
+    int merged = 0;
+    for (int c = 0; c < count; c++) {
+        int survivor = collisions[c].first;
+        int absorbed = collisions[c].second;
+        if (!sim->bodies[survivor].isAlive || !sim->bodies[absorbed].isAlive) continue;
+
+        // Planets and stars always come first; between asteroids the heavier one stays
+        if (survivor >= sim->systemBodies && sim->bodies[absorbed].mass > sim->bodies[survivor].mass) {
+            survivor = collisions[c].second;
+            absorbed = collisions[c].first;
+        }
+        MergeBodies(sim, survivor, absorbed);
+        merged++;
+    }
+
+    rewindArena(sim->arena, mark);
+    return merged;
+}
+
+/**
+ * @brief Phase 6: follows the asteroids near planets and records the close
+ * approaches completed during the step. Needs every body and runs before
+ * the time advances. Returns the number of approaches completed.
+ */
+int trackCloseApproaches(OrbitalSim* sim) {
+    if (!sim->encounters) return 0;
+    return trackEncounters(sim->encounters, sim);
+}
+
+/**
+ * @brief Adds mass swallowed elsewhere (e.g. by a worker process) to the black hole
+ */
+void accreteIntoBlackHole(OrbitalSim* sim, double mass, int count) {
+    if (!sim->blackHole.isActive || count <= 0) return;
+    AccreteMass(sim, mass, count);
+}
+
+//***** FATE TRACKING FUNCTIONS *****//
+
+/**
+ * @brief Tells whether the last step repeats one whose events and metrics
+ * were already reported (it ended before a rollback)
+ */
+bool isReplayedStep(const OrbitalSim* sim) {
+    return sim->time < sim->replayedTime + 0.5 * sim->timeStep;
+}
+
+/**
+ * @brief Marks a body with the fate of an event and appends it to the history
+ * (e.g. events computed by a worker process)
+ */
+void recordFateEvent(OrbitalSim* sim, const FateEvent* event) {
+    if (event->body < 0 || event->body >= sim->numBodies) return;
+
+    sim->bodies[event->body].fate = (unsigned char)event->fate;
+
+    if (sim->fateEventCount == sim->fateEventCapacity) {
+        int capacity = (sim->fateEventCapacity > 0) ? 2 * sim->fateEventCapacity : 64;
+        FateEvent* events = (FateEvent*)realloc(sim->fateEvents, sizeof(FateEvent) * capacity);
+        if (!events) return; // The body keeps its fate; only the details are lost
+        sim->fateEvents = events;
+        sim->fateEventCapacity = capacity;
+        setAccountedMemory(&sim->memory, MEMORY_OUTPUT_BUFFERS, sizeof(FateEvent) * capacity);
+        addMetric(METRIC_ALLOCATIONS, 1);
+        addMetric(METRIC_ALLOCATED_BYTES, (double)(sizeof(FateEvent) * capacity));
+    }
+    sim->fateEvents[sim->fateEventCount++] = *event;
+}
+
+/**
+ * @brief Writes the fate of every body as CSV (one line per body, with the
+ * details of its last event)
+ */
+bool writeFateTable(const OrbitalSim* sim, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Cannot write fate table to %s\n", path);
+        return false;
+    }
+
+    // Last event of each body
+    int* lastEvent = (int*)malloc(sizeof(int) * (sim->numBodies > 0 ? sim->numBodies : 1));
+    if (!lastEvent) {
+        fclose(file);
+        return false;
+    }
+    for (int i = 0; i < sim->numBodies; i++) lastEvent[i] = -1;
+    for (int i = 0; i < sim->fateEventCount; i++) lastEvent[sim->fateEvents[i].body] = i;
+
+    static const char* fateNames[] = { "active", "accreted", "ejected", "merged" };
+    fprintf(file, "body,fate,time,relative_speed,black_hole_mass,merged_into\n");
+    for (int i = 0; i < sim->numBodies; i++) {
+        if (lastEvent[i] < 0) {
+            fprintf(file, "%d,%s,,,,\n", i, fateNames[sim->bodies[i].fate]);
+            continue;
+        }
+        const FateEvent* event = &sim->fateEvents[lastEvent[i]];
+        fprintf(file, "%d,%s,%.1f,%g,%g,", i, fateNames[sim->bodies[i].fate],
+            event->time, event->relativeSpeed, event->blackHoleMass);
+        if (event->fate == BODY_FATE_MERGED) fprintf(file, "%d", event->target);
+        fprintf(file, "\n");
     }
 
-    free(accelerations);
+    free(lastEvent);
+    fclose(file);
+    return true;
+}
+
+//***** LEVEL OF DETAIL FUNCTIONS *****//
+
+/**
+ * @brief Asteroids within radius of position (e.g. around the camera) are
+ * integrated every step. A radius of 0 disables the focus.
+ */
+void setOrbitalSimFocus(OrbitalSim* sim, Vector3 position, float radius) {
+    sim->focusPosition = position;
+    sim->focusRadius = radius;
+}
+
+//***** SATELLITE FUNCTIONS *****//
+
+/**
+ * @brief Absolute position of a satellite of a subsystem
+ */
+Vector3 getSatellitePosition(const OrbitalSim* sim, const Subsystem* subsystem, int index) {
+    return Vector3Add(sim->bodies[subsystem->parent].position, sim->satellites[index].position);
 }
 
 //***** SYSTEM INITIALIZATION FUNCTIONS *****//
 
+/**
+ * @brief Resets the arena and carves the bodies and metadata arrays out of
+ * it. The arena leaves room for one step of scratch and is replaced only
+ * when too small. On failure (memory limit or no memory) nothing changes.
+ */
+static bool allocateBodies(OrbitalSim* sim, const SimConfig* config) {
+    int numBodies = getSystemBodyCount(config->systemType) + config->asteroidCount;
+    int numSatellites = getSystemSatelliteCount(config->systemType);
+    int ringParticles = getSystemRingParticles(config);
+    bool hugePages = config->hugePages;
+
+    size_t bodyBytes = (sizeof(OrbitalBody) + sizeof(BodyMetadata)) * numBodies +
+        (sizeof(Satellite) + sizeof(BodyMetadata) + sizeof(Vector3)) * numSatellites +
+        6 * sizeof(float) * (size_t)ringParticles +
+        (config->compensated ? sizeof(Compensation) * (size_t)(numBodies + numSatellites) : 0);
+    size_t scratchBytes = sizeof(Vector3) * (size_t)(numBodies + numSatellites) +
+        (config->hybrid ? getHybridBytes(getSystemBodyCount(config->systemType)) : 0);
+    size_t spatialBytes = config->collisions ? getCollisionBytes(numBodies) : 0;
+    size_t total = bodyBytes + scratchBytes + spatialBytes;
+    size_t needed = total + 16 * ARENA_ALIGNMENT;
+
+    // Only growth counts against the limit
+    size_t current = sim->memory.bytes[MEMORY_BODIES] + sim->memory.bytes[MEMORY_SCRATCH] +
+        sim->memory.bytes[MEMORY_SPATIAL_INDEX];
+    if (total > current && !fitsMemoryLimit(total - current)) {
+        printf("Memory: %d bodies need %zu bytes, over the limit of %zu bytes\n",
+            numBodies, total, getMemoryLimit());
+        return false;
+    }
+
+    if (!sim->arena || sim->arena->capacity < needed) {
+        size_t capacity = (2 * needed > ARENA_MIN_CAPACITY) ? 2 * needed : ARENA_MIN_CAPACITY;
+        Arena* arena = constructArena(capacity, hugePages);
+        if (!arena) return false;
+
+        destroyArena(sim->arena);
+        sim->arena = arena;
+        addMetric(METRIC_ALLOCATIONS, 1);
+        addMetric(METRIC_ALLOCATED_BYTES, (double)arena->capacity);
+    }
+
+    // Cannot fail: the arena holds needed bytes
+    resetArena(sim->arena);
+    sim->bodies = (OrbitalBody*)allocateArena(sim->arena, sizeof(OrbitalBody) * numBodies);
+    sim->metadata = (BodyMetadata*)allocateArena(sim->arena, sizeof(BodyMetadata) * numBodies);
+    sim->satellites = (Satellite*)allocateArena(sim->arena, sizeof(Satellite) * numSatellites);
+    sim->satelliteMetadata = (BodyMetadata*)allocateArena(sim->arena, sizeof(BodyMetadata) * numSatellites);
+    sim->satelliteTides = (Vector3*)allocateArena(sim->arena, sizeof(Vector3) * numSatellites);
+    sim->accelerations = (Vector3*)allocateArena(sim->arena, sizeof(Vector3) * numBodies);
+    sim->satelliteAccelerations = (Vector3*)allocateArena(sim->arena, sizeof(Vector3) * numSatellites);
+    sim->numSatellites = numSatellites;
+    sim->numSubsystems = 0;
+
+    sim->compensation = NULL;
+    sim->satelliteCompensation = NULL;
+    if (config->compensated) {
+        sim->compensation = (Compensation*)allocateArena(sim->arena, sizeof(Compensation) * numBodies);
+        sim->satelliteCompensation = (Compensation*)allocateArena(sim->arena, sizeof(Compensation) * numSatellites);
+        memset(sim->compensation, 0, sizeof(Compensation) * numBodies);
+        memset(sim->satelliteCompensation, 0, sizeof(Compensation) * numSatellites);
+    }
+
+    RingSystem* rings = &sim->rings;
+    float** arrays[6] = { &rings->x, &rings->y, &rings->z, &rings->vx, &rings->vy, &rings->vz };
+    for (int i = 0; i < 6; i++) {
+        *arrays[i] = (float*)allocateArena(sim->arena, sizeof(float) * ringParticles);
+    }
+    rings->count = ringParticles;
+    rings->parent = -1;
+    rings->substeps = 0;
+
+    SweepEntry* entries = NULL;
+    if (config->collisions) {
+        entries = (SweepEntry*)allocateArena(sim->arena, sizeof(SweepEntry) * numBodies);
+    }
+    initializeSweepIndex(&sim->sweep, entries, numBodies);
+    setAccountedMemory(&sim->memory, MEMORY_BODIES, bodyBytes);
+    setAccountedMemory(&sim->memory, MEMORY_SCRATCH, scratchBytes);
+    setAccountedMemory(&sim->memory, MEMORY_SPATIAL_INDEX, spatialBytes);
+    return true;
+}
+
+/**
+ * @brief Fills the metadata of a system body from its ephemerides
+ */
+static void setBodyMetadata(OrbitalSim* sim, int index, const EphemeridesBody* body) {
+    BodyMetadata* metadata = &sim->metadata[index];
+    metadata->name = body->name;
+    metadata->color = body->color;
+    metadata->radius = body->radius;
+    metadata->type = (body->mass > STAR_MIN_MASS) ? BODY_TYPE_STAR : BODY_TYPE_PLANET;
+    metadata->id = index;
+}
+
 /**
  * @brief Initialize Solar System
  */
 static void initializeSolarSystem(OrbitalSim* sim) {
     for (int i = 0; i < SOLARSYSTEM_BODYNUM && i < sim->numBodies; i++) {
         sim->bodies[i].mass = solarSystem[i].mass;
-        sim->bodies[i].radius = solarSystem[i].radius;
         sim->bodies[i].position = solarSystem[i].position;
         sim->bodies[i].velocity = solarSystem[i].velocity;
-        sim->bodies[i].color = solarSystem[i].color;
         sim->bodies[i].isAlive = true;
+        sim->bodies[i].fate = BODY_FATE_ACTIVE;
+        sim->bodies[i].tier = BODY_TIER_FULL;
+        setBodyMetadata(sim, i, &solarSystem[i]);
     }
+
+    initializeSatellites(sim, solarSystem, solarSystemMoons, sim->numSatellites);
+    initializeRings(sim, &saturnRings);
 }
 
 /**
@@ -202,27 +846,154 @@ static void initializeAlphaCentauriSystem(OrbitalSim* sim) {
     // For now, use modified solar system as placeholder
     for (int i = 0; i < ALPHACENTAURISYSTEM_BODYNUM; i++) {
         sim->bodies[i].mass = alphaCentauriSystem[i].mass;
-        sim->bodies[i].radius = alphaCentauriSystem[i].radius;
         sim->bodies[i].position = alphaCentauriSystem[i].position;
         sim->bodies[i].velocity = alphaCentauriSystem[i].velocity;
-        sim->bodies[i].color = alphaCentauriSystem[i].color;
         sim->bodies[i].isAlive = true;
+        sim->bodies[i].fate = BODY_FATE_ACTIVE;
+        sim->bodies[i].tier = BODY_TIER_FULL;
+        setBodyMetadata(sim, i, &alphaCentauriSystem[i]);
+    }
+}
+
+/**
+ * @brief Initialize satellites from their ephemerides (grouped by parent),
+ * one subsystem per parent. The parent shape comes from the system bodies.
+ */
+static void initializeSatellites(OrbitalSim* sim, const EphemeridesBody* bodies, const EphemeridesMoon* moons, int count) {
+    for (int i = 0; i < count; i++) {
+        if (i == 0 || moons[i].parent != moons[i - 1].parent) {
+            if (sim->numSubsystems == MAX_SUBSYSTEMS) break;
+            Subsystem* subsystem = &sim->subsystems[sim->numSubsystems++];
+            subsystem->parent = moons[i].parent;
+            subsystem->first = i;
+            subsystem->count = 0;
+            subsystem->substeps = 0;
+            subsystem->j2 = bodies[moons[i].parent].j2;
+            subsystem->referenceRadius = bodies[moons[i].parent].referenceRadius;
+            subsystem->pole = bodies[moons[i].parent].pole;
+        }
+        sim->subsystems[sim->numSubsystems - 1].count++;
+
+        Satellite* satellite = &sim->satellites[i];
+        satellite->position = moons[i].position;
+        satellite->velocity = moons[i].velocity;
+        satellite->mass = moons[i].mass;
+        satellite->isAlive = true;
+        sim->satelliteTides[i] = { 0.0f, 0.0f, 0.0f };
+
+        BodyMetadata* metadata = &sim->satelliteMetadata[i];
+        metadata->name = moons[i].name;
+        metadata->color = moons[i].color;
+        metadata->radius = moons[i].radius;
+        metadata->type = BODY_TYPE_MOON;
+        metadata->id = i;
+    }
+}
+
+/**
+ * @brief Initialize ring particles on circular equatorial orbits (J2
+ * corrected), uniform in area between the edges and outside the gap
+ */
+static void initializeRings(OrbitalSim* sim, const EphemeridesRing* rings) {
+    RingSystem* ring = &sim->rings;
+    if (ring->count == 0) return;
+
+    ring->parent = rings->parent;
+    ring->j2 = rings->j2;
+    ring->referenceRadius = rings->referenceRadius;
+    ring->innerRadius = rings->innerRadius;
+    ring->color = rings->color;
+
+    // Equatorial frame: x in the ecliptic, z along the spin axis
+    Vector3 pole = Vector3Normalize(rings->pole);
+    ring->axes[0] = Vector3Normalize(Vector3CrossProduct({ 0.0f, 1.0f, 0.0f }, pole));
+    ring->axes[1] = Vector3CrossProduct(pole, ring->axes[0]);
+    ring->axes[2] = pole;
+
+    float mu = GRAVITATIONAL_CONSTANT * sim->bodies[ring->parent].mass;
+    float inner2 = rings->innerRadius * rings->innerRadius;
+    float outer2 = rings->outerRadius * rings->outerRadius;
+    for (int i = 0; i < ring->count; i++) {
+        float r;
+        do {
+            r = sqrtf(getRandomFloat(inner2, outer2));
+        } while (r > rings->gapInner && r < rings->gapOuter);
+        float phi = getRandomFloat(0, 2.0F * (float)M_PI);
+
+        // Simulation axes are left-handed: clockwise in this frame is
+        // prograde, like the planet orbits
+        float ratio = rings->referenceRadius / r;
+        float v = sqrtf(mu / r * (1.0f + 1.5f * rings->j2 * ratio * ratio));
+        ring->x[i] = r * cosf(phi);
+        ring->y[i] = r * sinf(phi);
+        ring->z[i] = getRandomFloat(-10.0F, 10.0F); // Ring thickness
+        ring->vx[i] = v * sinf(phi);
+        ring->vy[i] = -v * cosf(phi);
+        ring->vz[i] = 0.0f;
     }
 }
 
 /**
  * @brief Initialize asteroids with specified count and dispersion
  */
-static void initializeAsteroids(OrbitalSim* sim, int count, DispersionType dispersion) {
+static void initializeAsteroids(OrbitalSim* sim, int count, DispersionType dispersion,
+    SimProgressCallback progress, void* context) {
     float centerMass = (sim->systemBodies > 0) ? sim->bodies[0].mass : 1.989E30f;
 
     for (int i = sim->systemBodies; i < sim->systemBodies + count && i < sim->numBodies; i++) {
+        if (progress && (i - sim->systemBodies) % PROGRESS_INTERVAL == 0) {
+            progress(context, (float)(i - sim->systemBodies) / count);
+        }
+
         if (sim->config.easterEgg == EASTER_EGG_PHI) {
             configureAsteroid(&sim->bodies[i], centerMass, dispersion, 1);
         }
         else {
             configureAsteroid(&sim->bodies[i], centerMass, dispersion, 0);
         }
+
+        BodyMetadata* metadata = &sim->metadata[i];
+        metadata->name = NULL;
+        metadata->color = GRAY;
+        metadata->radius = 2E3F;
+        metadata->type = BODY_TYPE_ASTEROID;
+        metadata->id = i;
+    }
+}
+
+/**
+ * @brief Moves the bodies to the heliocentric frame (satellites and rings are
+ * already relative to their parent)
+ */
+static void centerOnStar(OrbitalSim* sim) {
+    Vector3 origin = sim->bodies[0].position;
+    Vector3 velocity = sim->bodies[0].velocity;
+    sim->frameOrigin = origin;
+    sim->frameVelocity = velocity;
+    for (int i = 0; i < sim->numBodies; i++) {
+        sim->bodies[i].position = Vector3Subtract(sim->bodies[i].position, origin);
+        sim->bodies[i].velocity = Vector3Subtract(sim->bodies[i].velocity, velocity);
+    }
+}
+
+/**
+ * @brief Applies the mass changes of the configured easter egg
+ */
+static void applyEasterEgg(OrbitalSim* sim) {
+    if (sim->config.easterEgg == EASTER_EGG_JUPITER_1000X)
+    {
+        if (sim->config.systemType == SYSTEM_TYPE_SOLAR && sim->numBodies > 5) {
+            sim->bodies[5].mass *= 1000.0;
+
+            // Keep the moons on their orbits around the heavier planet
+            for (int s = 0; s < sim->numSubsystems; s++) {
+                const Subsystem* subsystem = &sim->subsystems[s];
+                if (subsystem->parent != 5) continue;
+                for (int i = subsystem->first; i < subsystem->first + subsystem->count; i++) {
+                    sim->satellites[i].velocity = Vector3Scale(sim->satellites[i].velocity, sqrtf(1000.0f));
+                }
+            }
+        }
     }
 }
 
@@ -265,6 +1036,28 @@ const char* getSystemName(SystemType system) {
     }
 }
 
+/**
+ * @brief Number of planets/stars of a system
+ */
+int getSystemBodyCount(SystemType system) {
+    return (system == SYSTEM_TYPE_SOLAR) ? SOLARSYSTEM_BODYNUM : ALPHACENTAURISYSTEM_BODYNUM;
+}
+
+/**
+ * @brief Ring particles a configuration creates
+ */
+int getSystemRingParticles(const SimConfig* config) {
+    if (config->systemType != SYSTEM_TYPE_SOLAR || config->ringParticles < 0) return 0;
+    return config->ringParticles;
+}
+
+/**
+ * @brief Number of moons of a system
+ */
+int getSystemSatelliteCount(SystemType system) {
+    return (system == SYSTEM_TYPE_SOLAR) ? SOLARSYSTEM_MOONNUM : 0;
+}
+
 /**
  * @brief Get easter egg name
  */
@@ -311,30 +1104,28 @@ static void configureAsteroid(OrbitalBody* body, float centerMass, DispersionTyp
     }
 
     body->mass = 1E12F;
-    body->radius = 2E3F;
     body->position = { r * cosf(phi), 0, r * sinf(phi) };
     body->velocity = { -v * sinf(phi), vy, v * cosf(phi) };
-    body->color = GRAY;
     body->isAlive = true;
+    body->fate = BODY_FATE_ACTIVE;
+    body->tier = BODY_TIER_FULL;
 }
 
 //***** PHYSICS COMPUTATION FUNCTIONS *****//
 
 /**
- * @brief Calculates gravitational accelerations for all bodies
+ * @brief Calculates gravitational accelerations between system bodies, plus
+ * the StarTerm of the central star on the others
  */
-
-static void ComputeGravitationalAccelerations(OrbitalSim *sim, OrbitalBody* bodies, Vector3* accelerations, int n) {
-    const double MIN_DISTANCE_CUBED = 1E29;   // Minimum distance cubed to avoid singularities
-    const double INFLUENCE_DISTANCE_SQ = 1E15; // Threshold for planet-asteroid interactions
-
-    // 1. Initialize all accelerations to zero
-    for (int i = 0; i < n; i++) {
+template <class StarTerm>
+static void ComputeSystemAccelerations(OrbitalSim* sim, OrbitalBody* bodies, Vector3* accelerations) {
+    // 1. Initialize system accelerations to zero
+    int systemBodies = sim->systemBodies;
+    for (int i = 0; i < systemBodies; i++) {
         accelerations[i] = { 0.0f, 0.0f, 0.0f };
     }
 
     // 2. Compute gravitational interactions between system bodies
-    int systemBodies = sim->systemBodies;
     for (int i = 0; i < systemBodies; i++) {
         if (!bodies[i].isAlive) continue;
 
@@ -342,167 +1133,506 @@ static void ComputeGravitationalAccelerations(OrbitalSim *sim, OrbitalBody* bodi
             if (!bodies[j].isAlive) continue;
             Vector3 r_vec = Vector3Subtract(bodies[j].position, bodies[i].position);
             double r_squared = Vector3LengthSqr(r_vec);
-            double r_cubed = r_squared * sqrt(r_squared);
-
-            double force_magnitude;
-            Vector3 accel_j;
-            Vector3 accel_i;
-
-            if (r_cubed > MIN_DISTANCE_CUBED) {
-                force_magnitude = GRAVITATIONAL_CONSTANT / r_cubed;
-                accel_j = Vector3Scale(r_vec, -force_magnitude * bodies[i].mass);
-                accelerations[j] = Vector3Add(accelerations[j], accel_j);
-                accel_i = Vector3Scale(r_vec, force_magnitude * bodies[j].mass);
-                accelerations[i] = Vector3Add(accelerations[i], accel_i);
-            }
-            else {
-                force_magnitude = GRAVITATIONAL_CONSTANT / MIN_DISTANCE_CUBED;
-                accel_j = Vector3Scale(r_vec, -force_magnitude * bodies[i].mass);
-                accelerations[j] = Vector3Add(accelerations[j], accel_j);
-                accel_i = Vector3Scale(r_vec, force_magnitude * bodies[j].mass);
-                accelerations[i] = Vector3Add(accelerations[i], accel_i);
-            }
+            double force_magnitude = GRAVITATIONAL_CONSTANT * ExactInverseCube::get(r_squared, MIN_DISTANCE_CUBED);
+
+            Vector3 accel_j = Vector3Scale(r_vec, -force_magnitude * bodies[i].mass);
+            accelerations[j] = Vector3Add(accelerations[j], accel_j);
+            Vector3 accel_i = Vector3Scale(r_vec, force_magnitude * bodies[j].mass);
+            accelerations[i] = Vector3Add(accelerations[i], accel_i);
         }
     }
 
-    // 3. Compute gravitational acceleration from primary star to asteroids
-    if (n > systemBodies && bodies[0].isAlive) {
-        for (int i = systemBodies; i < n; i++) {
-            if (!bodies[i].isAlive) continue;
+    // 3. Optional terms of the central star
+    if (!bodies[0].isAlive) return;
+    StarTerms star = getStarTerms(GRAVITATIONAL_CONSTANT * bodies[0].mass, bodies[0].mass);
+    for (int j = 1; j < systemBodies; j++) {
+        if (!bodies[j].isAlive) continue;
+        StarTerm::add(star, Vector3Subtract(bodies[j].position, bodies[0].position),
+            Vector3Subtract(bodies[j].velocity, bodies[0].velocity), &accelerations[j]);
+    }
+}
 
-            Vector3 r_vec = Vector3Subtract(bodies[i].position, bodies[0].position);
-            double r_squared = Vector3LengthSqr(r_vec);
-            double r_cubed = r_squared * sqrt(r_squared);
+/**
+ * @brief Swallows the bodies in [begin, end) inside the accretion radius.
+ * Returns how many were swallowed.
+ */
+static int HandleBlackHoleCollision(OrbitalSim* sim, int begin, int end) {
+    BlackHole* blackHole = &sim->blackHole;
+    OrbitalBody* body = sim->bodies;
+    int accreted = 0;
+    for (int i = begin; i < end; i++) {
+        if (!body[i].isAlive || body[i].tier != BODY_TIER_FULL) continue;
 
-            double force_magnitude;
-            Vector3 accel_asteroid;
+		// Calculate accretion radius
+        float ACCRETION_RADIUS = fmaxf(blackHole->radius,
+            0.05f * Vector3Length(Vector3Add(body[i].position, sim->frameOrigin)));
 
-            if (r_cubed > MIN_DISTANCE_CUBED) {
-                force_magnitude = GRAVITATIONAL_CONSTANT * bodies[0].mass / r_cubed;
-                accel_asteroid = Vector3Scale(r_vec, -force_magnitude);
-                accelerations[i] = Vector3Add(accelerations[i], accel_asteroid);
-            }
-            else {
-                force_magnitude = GRAVITATIONAL_CONSTANT * bodies[0].mass / MIN_DISTANCE_CUBED;
-                accel_asteroid = Vector3Scale(r_vec, -force_magnitude);
-                accelerations[i] = Vector3Add(accelerations[i], accel_asteroid);
-            }
+		// Calculate distance to black hole
+        Vector3 distance_vec = Vector3Subtract(body[i].position, blackHole->position);
+        float distance = Vector3Length(distance_vec);
 
-            if (sim->config.easterEgg == EASTER_EGG_JUPITER_1000X)
-            {
-                if (sim->config.systemType == SYSTEM_TYPE_SOLAR && sim->numBodies > 5) {
-                    r_vec = Vector3Subtract(bodies[i].position, bodies[5].position);
-                    r_squared = Vector3LengthSqr(r_vec);
-                    r_cubed = r_squared * sqrt(r_squared);
-
-                    if (r_cubed > MIN_DISTANCE_CUBED) {
-                        force_magnitude = GRAVITATIONAL_CONSTANT * bodies[5].mass / r_cubed;
-                        accel_asteroid = Vector3Scale(r_vec, -force_magnitude);
-                        accelerations[i] = Vector3Add(accelerations[i], accel_asteroid);
-                    }
-                    else {
-                        force_magnitude = GRAVITATIONAL_CONSTANT * bodies[5].mass / MIN_DISTANCE_CUBED;
-                        accel_asteroid = Vector3Scale(r_vec, -force_magnitude);
-                        accelerations[i] = Vector3Add(accelerations[i], accel_asteroid);
-                    }
-                }
-            }
-            if (sim->config.systemType == SYSTEM_TYPE_ALPHA_CENTAURI)
-            {
-                r_vec = Vector3Subtract(bodies[i].position, bodies[1].position);
-                r_squared = Vector3LengthSqr(r_vec);
-                r_cubed = r_squared * sqrt(r_squared);
-
-                if (r_cubed > MIN_DISTANCE_CUBED) {
-                    force_magnitude = GRAVITATIONAL_CONSTANT * bodies[1].mass / r_cubed;
-                    accel_asteroid = Vector3Scale(r_vec, -force_magnitude);
-                    accelerations[i] = Vector3Add(accelerations[i], accel_asteroid);
-                }
-                else {
-                    force_magnitude = GRAVITATIONAL_CONSTANT * bodies[1].mass / MIN_DISTANCE_CUBED;
-                    accel_asteroid = Vector3Scale(r_vec, -force_magnitude);
-                    accelerations[i] = Vector3Add(accelerations[i], accel_asteroid);
-                }
-            }
+        // Verify collision
+        if (distance < ACCRETION_RADIUS) {
+            body[i].isAlive = false;
+            AccreteMass(sim, body[i].mass, 1);
+            RecordFate(sim, i, BODY_FATE_ACCRETED,
+                Vector3Length(Vector3Subtract(body[i].velocity, blackHole->velocity)), -1);
+            accreted++;
         }
     }
+    return accreted;
+}
 
-    // 4. Compute gravitational acceleration from planets to asteroids (if within influence distance)
-    for (int i = 1; i < systemBodies; i++) { // Skip primary star (index 0)
-        if (!bodies[i].isAlive) continue;
+/**
+ * @brief Flags the bodies in [begin, end) that are far from the central body
+ * and no longer bound to it. Ejected bodies keep being simulated.
+ */
+static void DetectEjections(OrbitalSim* sim, int begin, int end) {
+    OrbitalBody* bodies = sim->bodies;
+    if (sim->numBodies == 0 || !bodies[0].isAlive) return;
 
-        for (int j = systemBodies; j < n; j++) {
-            if (!bodies[j].isAlive) continue;
+    for (int i = (begin > 0) ? begin : 1; i < end; i++) {
+        if (!bodies[i].isAlive || bodies[i].fate != BODY_FATE_ACTIVE) continue;
 
-            Vector3 r_vec = Vector3Subtract(bodies[j].position, bodies[i].position);
-            double r_squared = Vector3LengthSqr(r_vec);
+        Vector3 r = Vector3Subtract(bodies[i].position, bodies[0].position);
+        float distanceSq = Vector3LengthSqr(r);
+        if (distanceSq < EJECTION_DISTANCE * EJECTION_DISTANCE) continue;
 
-            if (r_squared < INFLUENCE_DISTANCE_SQ && r_squared > MIN_DISTANCE_CUBED) {
-                double r_cubed = r_squared * sqrt(r_squared);
-                double force_magnitude = GRAVITATIONAL_CONSTANT / r_cubed;
-                Vector3 accel_asteroid = Vector3Scale(r_vec, -force_magnitude * bodies[i].mass);
-                accelerations[j] = Vector3Add(accelerations[j], accel_asteroid);
-            }
-            else if (r_squared < INFLUENCE_DISTANCE_SQ) {
-                double force_magnitude = GRAVITATIONAL_CONSTANT / MIN_DISTANCE_CUBED;
-                Vector3 accel_asteroid = Vector3Scale(r_vec, -force_magnitude * bodies[i].mass);
-                accelerations[j] = Vector3Add(accelerations[j], accel_asteroid);
-            }
+        // Positive specific orbital energy: unbound
+        Vector3 v = Vector3Subtract(bodies[i].velocity, bodies[0].velocity);
+        float speedSq = Vector3LengthSqr(v);
+        if (0.5f * speedSq > GRAVITATIONAL_CONSTANT * bodies[0].mass / sqrtf(distanceSq)) {
+            RecordFate(sim, i, BODY_FATE_EJECTED, sqrtf(speedSq), -1);
         }
     }
 }
 
-static void ComputeBlackHoleAcceleration(BlackHole* blackHole, OrbitalBody* bodies, Vector3* accelerations, int n) {
-    const double MIN_DISTANCE_CUBED = 1E29;
-    for (int i = 0; i < n; i++) {
-        if (!bodies[i].isAlive) continue;
+/**
+ * @brief Records a fate event of the current step (target: body merged
+ * into, -1 for other fates)
+ */
+static void RecordFate(OrbitalSim* sim, int body, BodyFate fate, float relativeSpeed, int target) {
+    FateEvent event;
+    event.body = body;
+    event.fate = fate;
+    event.time = sim->time;
+    event.relativeSpeed = relativeSpeed;
+    event.blackHoleMass = sim->blackHole.isActive ? sim->blackHole.mass : 0.0;
+    event.target = target;
+    recordFateEvent(sim, &event);
+}
+
+/**
+ * @brief Adds swallowed mass to the black hole and grows it
+ */
+static void AccreteMass(OrbitalSim* sim, double mass, int count) {
+    BlackHole* blackHole = &sim->blackHole;
+    blackHole->mass += mass;
+    blackHole->radius += sim->blackHoleMetadata.growthRate * count;
+    sim->blackHoleMetadata.eventHorizonRadius = 2.95f * (blackHole->mass / 1.989E30f) * 1E3f;
+}
+
+/**
+ * @brief Semi-implicit Euler step for the alive bodies in [begin, end), in
+ * a frame whose origin accelerates by frameAcceleration. With compensation
+ * (may be NULL) the sums carry what float rounding dropped.
+ */
+static void IntegrateBodies(OrbitalBody* bodies, const Vector3* accelerations, int begin, int end, float dt,
+    Vector3 frameAcceleration, Compensation* compensation) {
+    if (compensation) {
+        for (int i = begin; i < end; i++) {
+            if (!bodies[i].isAlive || bodies[i].tier != BODY_TIER_FULL) continue;
+            Compensation* error = &compensation[i];
+            bodies[i].velocity = AddCompensated(bodies[i].velocity,
+                Vector3Scale(Vector3Subtract(accelerations[i], frameAcceleration), dt), &error->velocity);
+
+            // The position moves with the compensated velocity
+            error->position = Vector3Add(error->position, Vector3Scale(error->velocity, dt));
+            bodies[i].position = AddCompensated(bodies[i].position,
+                Vector3Scale(bodies[i].velocity, dt), &error->position);
+        }
+        return;
+    }
+
+    for (int i = begin; i < end; i++) {
+		if (!bodies[i].isAlive || bodies[i].tier != BODY_TIER_FULL) continue; // Drift bodies move in AdvanceDriftTier
+        bodies[i].velocity = Vector3Add(bodies[i].velocity,
+            Vector3Scale(Vector3Subtract(accelerations[i], frameAcceleration), dt));
+
+        bodies[i].position = Vector3Add(bodies[i].position,
+            Vector3Scale(bodies[i].velocity, dt));
+    }
+}
+
+/**
+ * @brief sum + increment + *error rounded to float, leaving in *error what
+ * the rounding dropped (TwoSum per component: exact for any magnitudes)
+ */
+static Vector3 AddCompensated(Vector3 sum, Vector3 increment, Vector3* error) {
+    Vector3 corrected = Vector3Add(increment, *error);
+    Vector3 result = Vector3Add(sum, corrected);
+    Vector3 added = Vector3Subtract(result, sum);
+    *error = Vector3Add(Vector3Subtract(sum, Vector3Subtract(result, added)), Vector3Subtract(corrected, added));
+    return result;
+}
+
+/**
+ * @brief Absorbs a body into another. Mass, momentum and the center of mass
+ * are conserved; the radius grows with the added volume.
+ */
+static void MergeBodies(OrbitalSim* sim, int survivor, int absorbed) {
+    OrbitalBody* target = &sim->bodies[survivor];
+    OrbitalBody* body = &sim->bodies[absorbed];
+    double mass = target->mass + body->mass;
+    float weight = (float)(body->mass / mass);
+    float relativeSpeed = Vector3Length(Vector3Subtract(body->velocity, target->velocity));
+
+    target->position = Vector3Lerp(target->position, body->position, weight);
+    target->velocity = Vector3Lerp(target->velocity, body->velocity, weight);
+    target->mass = mass;
+    if (sim->compensation) {
+        sim->compensation[survivor] = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+    }
+
+    float r1 = sim->metadata[survivor].radius;
+    float r2 = sim->metadata[absorbed].radius;
+    sim->metadata[survivor].radius = cbrtf(r1 * r1 * r1 + r2 * r2 * r2);
+
+    body->isAlive = false;
+    RecordFate(sim, absorbed, BODY_FATE_MERGED, relativeSpeed, survivor);
+}
 
-        Vector3 r_vec = Vector3Subtract(bodies[i].position, blackHole->position);
-        float r_squared = Vector3LengthSqr(r_vec);
-        float r_cubed = r_squared * sqrtf(r_squared);
+/**
+ * @brief qsort order of collisions: contact time, then body indices
+ */
+static int compareCollisions(const void* a, const void* b) {
+    const Collision* first = (const Collision*)a;
+    const Collision* second = (const Collision*)b;
+    if (first->time != second->time) return (first->time < second->time) ? -1 : 1;
+    if (first->first != second->first) return first->first - second->first;
+    return first->second - second->second;
+}
 
-        if (r_cubed > MIN_DISTANCE_CUBED) {
-			// Force on the orbital body (towards the black hole)
-            float force_magnitude_body = (float)GRAVITATIONAL_CONSTANT * blackHole->mass / r_cubed;
-            Vector3 accel_body = Vector3Scale(r_vec, -force_magnitude_body);
-            accelerations[i] = Vector3Add(accelerations[i], accel_body);
+//***** LEVEL OF DETAIL PHYSICS *****//
+
+/**
+ * @brief Asteroids may be drifted around bodies[0] only when nothing but the
+ * central star pulls on them away from planets and the black hole (not with
+ * a 1000x Jupiter or a second star, which reach every asteroid). The hybrid
+ * integrator already follows their Kepler orbits exactly.
+ */
+static bool CanDrift(const OrbitalSim* sim) {
+    return sim->config.driftSteps > 1 && !sim->config.hybrid &&
+        sim->config.systemType == SYSTEM_TYPE_SOLAR &&
+        sim->config.easterEgg != EASTER_EGG_JUPITER_1000X &&
+        sim->numBodies > 0 && sim->bodies[0].isAlive;
+}
+
+/**
+ * @brief Multi-rate update of the asteroids in [begin, end), after the full
+ * tier was integrated. Records the central star, then each asteroid gets a
+ * slot every driftSteps steps (staggered by index): drift bodies are moved
+ * analytically over the whole interval, and every asteroid is reclassified.
+ *
+ * Drift bodies do not pull on the black hole (1E12 kg each).
+ */
+static void AdvanceDriftTier(OrbitalSim* sim, int begin, int end) {
+    OrbitalBody* bodies = sim->bodies;
+    int steps = (sim->config.driftSteps < DRIFT_MAX_STEPS) ? sim->config.driftSteps : DRIFT_MAX_STEPS;
+    long long step = llround(sim->time / sim->timeStep);
 
-			// Force on the black hole (towards the body)
-            float force_magnitude_blackHole = (float)GRAVITATIONAL_CONSTANT * bodies[i].mass / r_cubed;
-            Vector3 accel_blackHole = Vector3Scale(r_vec, force_magnitude_blackHole);
-            blackHole->acceleration = Vector3Add(blackHole->acceleration, accel_blackHole);
+    if (begin == 0) {
+        int slot = (int)(step % (DRIFT_MAX_STEPS + 1));
+        sim->centerPositions[slot] = bodies[0].position;
+        sim->centerVelocities[slot] = bodies[0].velocity;
+    }
+
+    if (!CanDrift(sim)) {
+        CatchUpDriftBodies(sim, step); // The star was swallowed
+        return;
+    }
+
+    float span = steps * sim->timeStep;
+    for (int i = (begin > sim->systemBodies) ? begin : sim->systemBodies; i < end; i++) {
+        if (!bodies[i].isAlive || (step + i) % steps != 0) continue;
+
+        bool wasDrifting = (bodies[i].tier == BODY_TIER_DRIFT);
+        if (wasDrifting) {
+            DriftBody(sim, i, step - steps, step);
         }
-        else {
-			// Force on the orbital body (minimum distance)
-            float force_magnitude_body = (float)GRAVITATIONAL_CONSTANT * blackHole->mass / MIN_DISTANCE_CUBED;
-            Vector3 accel_body = Vector3Scale(r_vec, -force_magnitude_body);
-            accelerations[i] = Vector3Add(accelerations[i], accel_body);
-
-			// Force on the black hole (minimum distance)
-            float force_magnitude_blackHole = (float)0.01f * GRAVITATIONAL_CONSTANT * bodies[i].mass / MIN_DISTANCE_CUBED;
-            Vector3 accel_blackHole = Vector3Scale(r_vec, force_magnitude_blackHole);
-            blackHole->acceleration = Vector3Add(blackHole->acceleration, accel_blackHole);
+
+        bool drift = IsUnperturbed(sim, i, span);
+        if (drift != wasDrifting) {
+            ShiftEulerVelocity(sim, i, drift ? 1.0f : -1.0f);
+            bodies[i].tier = drift ? BODY_TIER_DRIFT : BODY_TIER_FULL;
+            sim->driftBodies += drift ? 1 : -1;
         }
     }
 }
 
-static void HandleBlackHoleCollision(BlackHole * blackHole, OrbitalBody * body, int n) {
-    for (int i = 0; i < n; i++) {
-        if (!body[i].isAlive) continue;
+/**
+ * @brief Moves a drift body from its state at the end of fromStep to the end
+ * of toStep: Kepler orbit relative to the recorded central star
+ */
+static void DriftBody(OrbitalSim* sim, int index, long long fromStep, long long toStep) {
+    OrbitalBody* body = &sim->bodies[index];
+    int from = (int)(fromStep % (DRIFT_MAX_STEPS + 1));
+    int to = (int)(toStep % (DRIFT_MAX_STEPS + 1));
+
+    Vector3 position = Vector3Subtract(body->position, sim->centerPositions[from]);
+    Vector3 velocity = Vector3Subtract(body->velocity, sim->centerVelocities[from]);
+    KeplerDrift(&position, &velocity, GRAVITATIONAL_CONSTANT * sim->bodies[0].mass,
+        (double)(toStep - fromStep) * sim->timeStep);
+
+    body->position = Vector3Add(position, sim->centerPositions[to]);
+    body->velocity = Vector3Add(velocity, sim->centerVelocities[to]);
+    if (sim->compensation) {
+        sim->compensation[index] = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } }; // Recomputed from the float state
+    }
+}
 
-		// Calculate accretion radius
-        float ACCRETION_RADIUS = fmaxf(blackHole->radius, 0.05f * Vector3Length(body[i].position));
+/**
+ * @brief The semi-implicit Euler velocity lags the true velocity by half a
+ * kick. Converts between both when a body changes tier (sign +1: Euler to
+ * true, -1: true to Euler), with the star pull as the only force.
+ */
+static void ShiftEulerVelocity(OrbitalSim* sim, int index, float sign) {
+    OrbitalBody* body = &sim->bodies[index];
+    Vector3 r = Vector3Subtract(body->position, sim->bodies[0].position);
+    double distance = Vector3Length(r);
+    double kick = sign * 0.5 * sim->timeStep * GRAVITATIONAL_CONSTANT * sim->bodies[0].mass /
+        (distance * distance * distance);
+    body->velocity = Vector3Subtract(body->velocity, Vector3Scale(r, (float)kick));
+}
 
-		// Calculate distance to black hole
-        Vector3 distance_vec = Vector3Subtract(body[i].position, blackHole->position);
-        float distance = Vector3Length(distance_vec);
+/**
+ * @brief True when an asteroid can skip the next span seconds: away from the
+ * focus and the star softening, out of reach of every planet influence
+ * sphere and of the accretion radius, and with a negligible black hole tide
+ */
+static bool IsUnperturbed(const OrbitalSim* sim, int index, float span) {
+    const OrbitalBody* bodies = sim->bodies;
+    const OrbitalBody* body = &bodies[index];
 
-        // Verify collision
-        if (distance < ACCRETION_RADIUS) {
-            body[i].isAlive = false;
-            blackHole->mass += body[i].mass;
-            blackHole->radius += blackHole->growthRate;
-            blackHole->eventHorizonRadius = 2.95f * (blackHole->mass / 1.989E30f) * 1E3f;
+    if (sim->focusRadius > 0.0f &&
+        Vector3Distance(body->position, sim->focusPosition) < sim->focusRadius) return false;
+
+    double centerDistance = Vector3Distance(body->position, bodies[0].position);
+    if (centerDistance < DRIFT_MIN_CENTER_DISTANCE) return false;
+
+    for (int j = 1; j < sim->systemBodies; j++) {
+        if (!bodies[j].isAlive) continue;
+
+        float reach = sqrtf(INFLUENCE_DISTANCE_SQ) +
+            Vector3Distance(body->velocity, bodies[j].velocity) * span;
+        if (Vector3Distance(body->position, bodies[j].position) < DRIFT_MARGIN * reach) return false;
+    }
+
+    const BlackHole* blackHole = &sim->blackHole;
+    if (blackHole->isActive) {
+        double distance = Vector3Distance(body->position, blackHole->position);
+        float accretionRadius = fmaxf(blackHole->radius,
+            0.05f * Vector3Length(Vector3Add(body->position, sim->frameOrigin)));
+        float reach = accretionRadius + Vector3Distance(body->velocity, blackHole->velocity) * span;
+        if (distance < DRIFT_MARGIN * reach) return false;
+
+        // Differential pull on the asteroid and the star, relative to the star pull
+        double tide = 2.0 * blackHole->mass * centerDistance * centerDistance * centerDistance /
+            (bodies[0].mass * distance * distance * distance);
+        if (tide > DRIFT_TIDAL_LIMIT) return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Advances a two-body orbit (state relative to the central mass) by
+ * dt, through the double precision solver of the hybrid integrator
+ */
+static void KeplerDrift(Vector3* position, Vector3* velocity, double mu, double dt) {
+    double r[3] = { position->x, position->y, position->z };
+    double v[3] = { velocity->x, velocity->y, velocity->z };
+    keplerDrift(r, v, mu, dt);
+
+    *position = { (float)r[0], (float)r[1], (float)r[2] };
+    *velocity = { (float)v[0], (float)v[1], (float)v[2] };
+}
+
+/**
+ * @brief Brings every drift body to the end of lastStep and returns it to
+ * the full tier (e.g. before a black hole appears)
+ */
+static void CatchUpDriftBodies(OrbitalSim* sim, long long lastStep) {
+    if (sim->driftBodies == 0) return;
+
+    int steps = (sim->config.driftSteps < DRIFT_MAX_STEPS) ? sim->config.driftSteps : DRIFT_MAX_STEPS;
+    for (int i = sim->systemBodies; i < sim->numBodies; i++) {
+        if (sim->bodies[i].tier != BODY_TIER_DRIFT) continue;
+
+        long long behind = (lastStep + i) % steps;
+        if (behind > 0) {
+            DriftBody(sim, i, lastStep - behind, lastStep);
         }
+        ShiftEulerVelocity(sim, i, -1.0f);
+        sim->bodies[i].tier = BODY_TIER_FULL;
+    }
+    sim->driftBodies = 0;
+}
+
+//***** SATELLITE PHYSICS *****//
+
+/**
+ * @brief Pull of the other system bodies and the black hole on each
+ * satellite minus their pull on its parent (start of step state). The
+ * satellites do not pull back on the heliocentric bodies.
+ */
+static void ComputeSatelliteTides(OrbitalSim* sim) {
+    OrbitalBody* bodies = sim->bodies;
+
+    for (int s = 0; s < sim->numSubsystems; s++) {
+        const Subsystem* subsystem = &sim->subsystems[s];
+        const OrbitalBody* parent = &bodies[subsystem->parent];
+        if (!parent->isAlive) continue;
+
+        for (int i = subsystem->first; i < subsystem->first + subsystem->count; i++) {
+            double tide[3] = { 0.0, 0.0, 0.0 };
+            Vector3 position = sim->satellites[i].position;
+
+            for (int j = 0; j < sim->systemBodies; j++) {
+                if (j == subsystem->parent || !bodies[j].isAlive) continue;
+                AddTidalPull(tide, Vector3Subtract(bodies[j].position, parent->position), position, bodies[j].mass);
+            }
+            if (sim->blackHole.isActive) {
+                AddTidalPull(tide, Vector3Subtract(sim->blackHole.position, parent->position), position, sim->blackHole.mass);
+            }
+
+            sim->satelliteTides[i] = { (float)tide[0], (float)tide[1], (float)tide[2] };
+        }
+    }
+}
+
+/**
+ * @brief Adds the differential pull of a mass at toSource (relative to the
+ * parent) on a satellite at satellite (relative to the parent)
+ */
+static void AddTidalPull(double* tide, Vector3 toSource, Vector3 satellite, double mass) {
+    double fromParent[3] = { toSource.x, toSource.y, toSource.z };
+    double fromSatellite[3] = {
+        fromParent[0] - satellite.x, fromParent[1] - satellite.y, fromParent[2] - satellite.z
+    };
+
+    double parentSq = fromParent[0] * fromParent[0] + fromParent[1] * fromParent[1] + fromParent[2] * fromParent[2];
+    double satelliteSq = fromSatellite[0] * fromSatellite[0] + fromSatellite[1] * fromSatellite[1] +
+        fromSatellite[2] * fromSatellite[2];
+    double parentInverseCube = ExactInverseCube::get(parentSq, MIN_DISTANCE_CUBED);
+    double satelliteInverseCube = ExactInverseCube::get(satelliteSq, MIN_DISTANCE_CUBED);
+
+    double gm = GRAVITATIONAL_CONSTANT * mass;
+    for (int k = 0; k < 3; k++) {
+        tide[k] += gm * (fromSatellite[k] * satelliteInverseCube - fromParent[k] * parentInverseCube);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Advances every subsystem by one step in its parent frame: the
+ * substep follows the dynamical time of the innermost satellite, the tides
+ * are held over the step. Satellites of a swallowed parent are dropped.
+ */
+template <class PlanetTerm>
+static void AdvanceSubsystems(OrbitalSim* sim) {
+    for (int s = 0; s < sim->numSubsystems; s++) {
+        Subsystem* subsystem = &sim->subsystems[s];
+        const OrbitalBody* parent = &sim->bodies[subsystem->parent];
+        Satellite* satellites = &sim->satellites[subsystem->first];
+        const Vector3* tides = &sim->satelliteTides[subsystem->first];
+        int count = subsystem->count;
+
+        if (!parent->isAlive) {
+            for (int i = 0; i < count; i++) satellites[i].isAlive = false;
+            subsystem->substeps = 0;
+            continue;
+        }
+
+        // Substep length from the innermost satellite
+        double minDistanceSq = INFINITY;
+        for (int i = 0; i < count; i++) {
+            if (satellites[i].isAlive) minDistanceSq = fmin(minDistanceSq, Vector3LengthSqr(satellites[i].position));
+        }
+        if (minDistanceSq == INFINITY) continue;
+
+        double mu = GRAVITATIONAL_CONSTANT * parent->mass;
+        PlanetTerms planet = { mu, (double)subsystem->j2 * subsystem->referenceRadius * subsystem->referenceRadius,
+            subsystem->pole };
+        double dynamicalTime = sqrt(minDistanceSq * sqrt(minDistanceSq) / mu);
+        int substeps = (int)ceil(sim->timeStep / (SUBSTEP_ORBIT_FRACTION * dynamicalTime));
+        substeps = (substeps < 1) ? 1 : (substeps > MAX_SUBSTEPS) ? MAX_SUBSTEPS : substeps;
+        subsystem->substeps = substeps;
+        float h = sim->timeStep / substeps;
+
+        Vector3* accelerations = &sim->satelliteAccelerations[subsystem->first];
+        Compensation* errors = sim->satelliteCompensation ? &sim->satelliteCompensation[subsystem->first] : NULL;
+
+        for (int step = 0; step < substeps; step++) {
+            // Parent (two-body, reduced mass, PlanetTerm), the other satellites and the tides
+            for (int i = 0; i < count; i++) {
+                if (!satellites[i].isAlive) continue;
+
+                Vector3 r = satellites[i].position;
+                double rSq = Vector3LengthSqr(r);
+                double rInverseCube = ExactInverseCube::get(rSq, SATELLITE_MIN_DISTANCE_CUBED);
+                Vector3 acceleration = Vector3Add(tides[i],
+                    Vector3Scale(r, (float)(-GRAVITATIONAL_CONSTANT * (parent->mass + satellites[i].mass) * rInverseCube)));
+
+                for (int j = 0; j < count; j++) {
+                    if (j == i || !satellites[j].isAlive) continue;
+                    Vector3 d = Vector3Subtract(satellites[j].position, r);
+                    double dSq = Vector3LengthSqr(d);
+                    double dInverseCube = ExactInverseCube::get(dSq, SATELLITE_MIN_DISTANCE_CUBED);
+                    acceleration = Vector3Add(acceleration,
+                        Vector3Scale(d, (float)(GRAVITATIONAL_CONSTANT * satellites[j].mass * dInverseCube)));
+                }
+                PlanetTerm::add(planet, r, &acceleration);
+                accelerations[i] = acceleration;
+            }
+
+            // Semi-implicit Euler, as the heliocentric bodies
+            for (int i = 0; i < count; i++) {
+                if (!satellites[i].isAlive) continue;
+                if (errors) {
+                    satellites[i].velocity = AddCompensated(satellites[i].velocity,
+                        Vector3Scale(accelerations[i], h), &errors[i].velocity);
+                    errors[i].position = Vector3Add(errors[i].position, Vector3Scale(errors[i].velocity, h));
+                    satellites[i].position = AddCompensated(satellites[i].position,
+                        Vector3Scale(satellites[i].velocity, h), &errors[i].position);
+                    continue;
+                }
+                satellites[i].velocity = Vector3Add(satellites[i].velocity, Vector3Scale(accelerations[i], h));
+                satellites[i].position = Vector3Add(satellites[i].position, Vector3Scale(satellites[i].velocity, h));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Advances the ring particles in their planet frame. Only the parent
+ * pulls on them (tides are ~1E-9 of the planet pull). The rings of a
+ * swallowed planet are dropped with it.
+ */
+static void AdvanceRings(OrbitalSim* sim) {
+    RingSystem* ring = &sim->rings;
+    if (ring->count == 0) return;
+
+    const OrbitalBody* parent = &sim->bodies[ring->parent];
+    if (!parent->isAlive) {
+        ring->count = 0;
+        return;
+    }
+
+    double mu = GRAVITATIONAL_CONSTANT * parent->mass;
+    double dynamicalTime = sqrt(ring->innerRadius * (double)ring->innerRadius * ring->innerRadius / mu);
+    int substeps = (int)ceil(sim->timeStep / (SUBSTEP_ORBIT_FRACTION * dynamicalTime));
+    substeps = (substeps < 1) ? 1 : (substeps > MAX_SUBSTEPS) ? MAX_SUBSTEPS : substeps;
+    ring->substeps = substeps;
+
+    sim->kernels->ringParticles(ring, (float)mu, sim->timeStep / substeps, substeps);
+}
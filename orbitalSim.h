@@ -8,6 +8,13 @@
 #ifndef ORBITALSIM_H
 #define ORBITALSIM_H
 #include "raylib.h"
+#include "arena.h"
+#include "memoryStats.h"
+#include "rings.h"
+#include "collisions.h"
+#include "encounters.h"
+
+struct PhysicsKernels;
 
  /**
   * @brief System type enumeration
@@ -37,15 +44,122 @@ typedef enum {
 } DispersionType;
 
 /**
- * @brief Orbital body definition
+ * @brief Frame of the stored positions and velocities
+ */
+typedef enum {
+    FRAME_EPHEMERIS,     // Frame of the ephemeris tables (inertial)
+    FRAME_HELIOCENTRIC   // Central star at rest at the origin (accelerated with it)
+} FrameType;
+
+/**
+ * @brief Instruction set of the physics kernels
+ */
+typedef enum {
+    ISA_LEVEL_AUTO,      // Widest one the CPU supports
+    ISA_LEVEL_SSE2,      // Baseline of the target (SSE2 on x86-64)
+    ISA_LEVEL_AVX2,      // AVX2 and FMA
+    ISA_LEVEL_AVX512     // AVX-512 F, VL, DQ and BW
+} IsaLevel;
+
+/**
+ * @brief What happened to a body so far
+ */
+typedef enum {
+    BODY_FATE_ACTIVE,
+    BODY_FATE_ACCRETED,  // Swallowed by the black hole
+    BODY_FATE_EJECTED,   // Unbound from the central star and far away
+    BODY_FATE_MERGED     // Absorbed by another body it collided with
+} BodyFate;
+
+/**
+ * @brief Kind of body, for display and analysis
+ */
+typedef enum {
+    BODY_TYPE_STAR,
+    BODY_TYPE_PLANET,
+    BODY_TYPE_ASTEROID,
+    BODY_TYPE_MOON
+} BodyType;
+
+/**
+ * @brief How often an asteroid is integrated
+ */
+typedef enum {
+    BODY_TIER_FULL,  // Every step
+    BODY_TIER_DRIFT  // Kepler drift around the central star every config.driftSteps steps
+} BodyTier;
+
+#define DRIFT_MAX_STEPS 64
+
+/**
+ * @brief Orbital body definition (only what the physics kernels touch)
  */
 struct OrbitalBody {
     Vector3 position;
     Vector3 velocity;
     double mass;
-    double radius;
-    CLITERAL(Color) color;
     bool isAlive;
+    unsigned char fate; // BodyFate
+    unsigned char tier; // BodyTier
+};
+
+/**
+ * @brief Moon state, relative to the body it orbits
+ */
+struct Satellite {
+    Vector3 position; // Relative to the parent body [m]
+    Vector3 velocity; // Relative to the parent body [m/s]
+    double mass;
+    bool isAlive;
+};
+
+#define MAX_SUBSYSTEMS 8
+#define MAX_SUBSTEPS 1024 // Per step and subsystem
+
+/**
+ * @brief Satellites of one system body, integrated in its frame with their
+ * own substeps
+ */
+struct Subsystem {
+    int parent;    // Index in bodies
+    int first;     // First index in satellites
+    int count;
+    int substeps;  // Substeps of the last step
+    float j2;      // Oblateness coefficient of the parent (0: spherical)
+    float referenceRadius; // J2 reference radius [m]
+    Vector3 pole;  // Spin axis of the parent (unit, simulation axes)
+};
+
+/**
+ * @brief What rounding to float dropped from a body state, added back with
+ * the next update (compensated summation)
+ */
+struct Compensation {
+    Vector3 position; // [m]
+    Vector3 velocity; // [m/s]
+};
+
+/**
+ * @brief Per-body data the gravity kernels never read, indexed like bodies
+ */
+struct BodyMetadata {
+    const char* name;      // NULL for asteroids
+    CLITERAL(Color) color;
+    float radius;          // Physical radius [m] (read by collisions and radiation pressure)
+    unsigned char type;    // BodyType
+    int id;                // Stable ID (index at creation, kept until the next reset)
+};
+
+/**
+ * @brief Accretion, ejection or merge of a body
+ */
+struct FateEvent {
+    int body;              // Index in bodies (stable until the next reset)
+    int fate;              // BodyFate
+    double time;           // Simulation time of the event [s]
+    float relativeSpeed;   // Speed relative to the black hole (accretion) or the central body (ejection) [m/s]
+    double blackHoleMass;  // Black hole mass after the event [kg], 0 if inactive
+    int target;            // Body it merged into, -1 for other fates
 };
 
 /**
@@ -56,9 +170,15 @@ struct BlackHole {
     Vector3 velocity;
 	Vector3 acceleration;
     double mass;
-    double radius;
-    double eventHorizonRadius;
+    double radius; // Accretion radius [m]
     bool isActive;
+};
+
+/**
+ * @brief Black hole data the physics never reads
+ */
+struct BlackHoleMetadata {
+    double eventHorizonRadius;
     double growthRate; // Qué tan rápido crece cuando consume materia
 };
 
@@ -70,6 +190,17 @@ struct SimConfig {
     EasterEggType easterEgg;
     DispersionType dispersion;
     int asteroidCount;
+    bool hugePages; // Back the simulation arena with huge pages
+    int driftSteps; // Steps between updates of unperturbed asteroids (<= 1: every step)
+    int ringParticles; // Saturn ring particles (Solar System only)
+    bool collisions; // Merge bodies that touch (asteroids with each other and with planets/stars)
+    float encounterHillRadii; // Close approaches to planets are tracked within this many Hill radii (0: off)
+    bool hybrid; // Asteroids: Wisdom-Holman steps, close encounters integrated with Bulirsch-Stoer
+    int forceTerms; // ForceTerm bits of the optional force terms (0: Newtonian gravity only)
+    FrameType frame; // Frame of the stored state
+    bool compensated; // Carry the rounding error of the float state (compensated summation)
+    bool fastInverseSqrt; // Asteroid pulls from a fast reciprocal square root (relative error < 1.5E-5)
+    IsaLevel isa; // Widest instruction set of the physics kernels (ISA_LEVEL_AUTO: the CPU's)
 };
 
 /**
@@ -77,29 +208,103 @@ struct SimConfig {
  */
 struct OrbitalSim {
     float timeStep; // Time step in seconds
-    OrbitalBody* bodies; // Array of orbital bodies
+    OrbitalBody* bodies; // Array of orbital bodies (carved from arena)
+    BodyMetadata* metadata; // Names, colors and radii, indexed like bodies (carved from arena)
+    Arena* arena; // Physics arrays and per-step scratch, reset with the simulation
     int numBodies; // Number of orbital bodies
     int systemBodies; // Number of system bodies (planets/stars)
     int asteroidCount; // Number of asteroids
     float centerRadius; // Radius of the most massive object in the star system
     BlackHole blackHole; // El agujero negro
+    BlackHoleMetadata blackHoleMetadata;
     int aliveBodies; // Contador de cuerpos vivos
     SimConfig config; // Configuration used for this simulation
+    double time; // Simulated time in seconds since the last reset
+    int generation; // Incremented on every reset
+    bool isTrial; // Parareal copy: its steps are not part of the trajectory and are not counted in the metrics
+    double replayedTime; // Steps up to this time repeat ones already reported (after a rollback)
+    FateEvent* fateEvents; // Fate events since the last reset, in order
+    int fateEventCount;
+    int fateEventCapacity;
+    int stepEventBegin; // First fate event of the current step
+    MemoryAccount memory; // Bytes reported for this simulation
+    Vector3 focusPosition; // Asteroids near the focus (the camera) are never drifted
+    float focusRadius;
+    int driftBodies; // Asteroids currently in the drift tier
+    Vector3 centerPositions[DRIFT_MAX_STEPS + 1]; // Central star at the end of recent steps
+    Vector3 centerVelocities[DRIFT_MAX_STEPS + 1];
+    Vector3 frameOrigin; // Position of the frame origin in the ephemeris frame
+    Vector3 frameVelocity;
+    Vector3 frameAcceleration; // Acceleration of the frame origin this step (0 in the ephemeris frame)
+    Satellite* satellites; // Moons, grouped by subsystem (carved from arena)
+    BodyMetadata* satelliteMetadata; // Indexed like satellites (carved from arena)
+    Vector3* satelliteTides; // Pull of the other bodies relative to the parent, this step
+    Vector3* accelerations; // Per-step scratch indexed like bodies (carved from arena)
+    Vector3* satelliteAccelerations; // Per-substep scratch indexed like satellites (carved from arena)
+    Compensation* compensation; // Indexed like bodies (carved from arena), NULL when off
+    Compensation* satelliteCompensation; // Indexed like satellites, NULL when off
+    int numSatellites;
+    Subsystem subsystems[MAX_SUBSYSTEMS];
+    int numSubsystems;
+    RingSystem rings; // rings.count == 0 without rings
+    SweepIndex sweep; // Collision broad phase, sweep.entries == NULL without collisions
+    EncounterTracker* encounters; // Close approach tracking, NULL when off (and in clones)
+    const PhysicsKernels* kernels; // Build of the physics kernels picked from config.isa
 };
 
+/**
+ * @brief Reports construction progress (fraction in [0, 1]); may be called
+ * from the thread building the simulation
+ */
+typedef void (*SimProgressCallback)(void* context, float fraction);
+
 // Main simulation functions
 OrbitalSim* constructOrbitalSim(float timeStep, const SimConfig* config);
+OrbitalSim* buildOrbitalSim(float timeStep, const SimConfig* config, SimProgressCallback progress, void* context);
+void replaceOrbitalSim(OrbitalSim* sim, OrbitalSim* replacement);
+size_t getOrbitalSimBytes(const SimConfig* config);
 void destroyOrbitalSim(OrbitalSim* sim);
 void updateOrbitalSim(OrbitalSim* sim);
-void resetOrbitalSim(OrbitalSim* sim, const SimConfig* config);
+bool resetOrbitalSim(OrbitalSim* sim, const SimConfig* config);
+
+// State copy functions
+OrbitalSim* cloneOrbitalSim(const OrbitalSim* sim);
+OrbitalSim* cloneOrbitalSystem(const OrbitalSim* sim);
+bool copyOrbitalSimState(OrbitalSim* dst, const OrbitalSim* src);
+void copyOrbitalSystemState(OrbitalSim* dst, const OrbitalSim* src);
+
+// Step phase functions (updateOrbitalSim runs them in order; asteroid
+// ranges are independent and may be computed elsewhere)
+void computeSystemAccelerations(OrbitalSim* sim, Vector3* accelerations);
+void computeAsteroidRange(OrbitalSim* sim, Vector3* accelerations, int begin, int end);
+Vector3 computeAsteroidPull(const OrbitalSim* sim, Vector3* accelerations, int begin, int end);
+void advanceBlackHole(OrbitalSim* sim);
+int advanceBodyRange(OrbitalSim* sim, const Vector3* accelerations, int begin, int end);
+int resolveCollisions(OrbitalSim* sim);
+int trackCloseApproaches(OrbitalSim* sim);
+void accreteIntoBlackHole(OrbitalSim* sim, double mass, int count);
+
+// Fate tracking functions
+void recordFateEvent(OrbitalSim* sim, const FateEvent* event);
+bool isReplayedStep(const OrbitalSim* sim);
+bool writeFateTable(const OrbitalSim* sim, const char* path);
 
 // Black hole functions
 void createBlackHole(OrbitalSim* sim, Vector3 position);
 
+// Level of detail functions
+void setOrbitalSimFocus(OrbitalSim* sim, Vector3 position, float radius);
+
+// Satellite functions
+Vector3 getSatellitePosition(const OrbitalSim* sim, const Subsystem* subsystem, int index);
+
 // Configuration helper functions
 float getDispersionRange(DispersionType dispersion);
 const char* getDispersionName(DispersionType dispersion);
 const char* getSystemName(SystemType system);
+int getSystemBodyCount(SystemType system);
+int getSystemSatelliteCount(SystemType system);
+int getSystemRingParticles(const SimConfig* config);
 const char* getEasterEggName(EasterEggType easterEgg);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,232 @@
+/**
+ * @brief Implements asteroid force computation on a pool of worker threads
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * Each thread owns a contiguous asteroid range for a whole generation. With
+ * NUMA placement the threads are spread over the nodes and the pages of
+ * their range (bodies and step scratch) are migrated to their node, so the
+ * force phase only reads and writes local memory.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdio.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "metrics.h"
+#include "numa.h"
+#include "parallel.h"
+#include "raymath.h"
+
+/**
+ * @brief Thread state and the asteroid range it owns
+ */
+struct ParallelWorker {
+    std::thread thread;
+    int node;         // NUMA node, -1 without placement
+    int begin;        // First asteroid index owned
+    int end;          // One past the last asteroid index owned
+    Vector3 pull;     // Pull of the range on the black hole, last step
+};
+
+/**
+ * @brief Pool state. The coordinator publishes a step and waits for every
+ * worker to finish it.
+ */
+struct ParallelSim {
+    OrbitalSim* sim;
+    ParallelWorker workers[PARALLEL_MAX_THREADS];
+    int numThreads;
+    bool numa;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned int step;          // Incremented to start a step
+    int pending;                // Workers still busy with the step
+    bool running;
+
+    Vector3* accelerations;     // Scratch of the current step
+    bool place;                 // Migrate owned pages during this step
+    int generation;             // sim->generation the ranges were split for
+    OrbitalBody* bodies;        // sim->bodies the ranges were split for
+};
+
+static void splitRanges(ParallelSim* parallel);
+static void runWorker(ParallelSim* parallel, int index);
+
+/**
+ * @brief Starts the worker threads
+ */
+ParallelSim* constructParallelSim(OrbitalSim* sim, int threads, bool numa) {
+    if (!sim || threads < 1) return NULL;
+    if (threads > PARALLEL_MAX_THREADS) threads = PARALLEL_MAX_THREADS;
+
+    ParallelSim* parallel = new ParallelSim();
+    parallel->sim = sim;
+    parallel->numThreads = threads;
+    parallel->step = 0;
+    parallel->pending = 0;
+    parallel->running = true;
+    parallel->accelerations = NULL;
+    parallel->place = false;
+    parallel->generation = sim->generation - 1;
+    parallel->bodies = NULL;
+
+    // Placement only pays off with more than one node
+    int nodes = numa ? getNumaNodeCount() : 1;
+    parallel->numa = nodes > 1;
+    if (numa && !parallel->numa) {
+        printf("NUMA: single node, placement disabled\n");
+    }
+
+    for (int t = 0; t < threads; t++) {
+        ParallelWorker* worker = &parallel->workers[t];
+        worker->node = parallel->numa ? t % nodes : -1;
+        worker->begin = worker->end = 0;
+        worker->pull = { 0, 0, 0 };
+        worker->thread = std::thread(runWorker, parallel, t);
+    }
+
+    return parallel;
+}
+
+/**
+ * @brief Stops and joins the worker threads
+ */
+void destroyParallelSim(ParallelSim* parallel) {
+    if (!parallel) return;
+
+    {
+        std::lock_guard<std::mutex> guard(parallel->lock);
+        parallel->running = false;
+    }
+    parallel->wake.notify_all();
+
+    for (int t = 0; t < parallel->numThreads; t++) {
+        parallel->workers[t].thread.join();
+    }
+    delete parallel;
+}
+
+/**
+ * @brief Simulates a timestep with the asteroid forces computed by the pool.
+ *
+ * Range pulls on the black hole are added in range order, so results are
+ * deterministic for a given thread count (they differ from the serial step
+ * only by the rounding of that sum).
+ */
+void updateParallelSim(ParallelSim* parallel) {
+    OrbitalSim* sim = parallel->sim;
+    int n = sim->numBodies;
+
+    if (sim->generation != parallel->generation || sim->bodies != parallel->bodies) {
+        splitRanges(parallel);
+    }
+
+    Vector3* accelerations = sim->accelerations;
+    size_t mark = markArena(sim->arena); // Hybrid and collision scratch
+
+    sim->stepEventBegin = sim->fateEventCount;
+
+    double start = getMetricsTime();
+    computeSystemAccelerations(sim, accelerations);
+    double systemEnd = getMetricsTime();
+
+    // Asteroid ranges on the pool
+    {
+        std::unique_lock<std::mutex> guard(parallel->lock);
+        parallel->accelerations = accelerations;
+        parallel->pending = parallel->numThreads;
+        parallel->step++;
+        parallel->wake.notify_all();
+        parallel->done.wait(guard, [parallel] { return parallel->pending == 0; });
+    }
+    parallel->place = false;
+
+    if (sim->blackHole.isActive) {
+        for (int t = 0; t < parallel->numThreads; t++) {
+            sim->blackHole.acceleration = Vector3Add(sim->blackHole.acceleration, parallel->workers[t].pull);
+        }
+    }
+    double asteroidsEnd = getMetricsTime();
+
+    advanceBlackHole(sim);
+    int accreted = advanceBodyRange(sim, accelerations, 0, n);
+    int merged = resolveCollisions(sim);
+    trackCloseApproaches(sim);
+    double advanceEnd = getMetricsTime();
+
+    sim->aliveBodies -= accreted + merged;
+    sim->time += sim->timeStep;
+    rewindArena(sim->arena, mark);
+
+    addMetric(METRIC_PHASE_SYSTEM_SECONDS, systemEnd - start);
+    addMetric(METRIC_PHASE_ASTEROIDS_SECONDS, asteroidsEnd - systemEnd);
+    addMetric(METRIC_PHASE_ADVANCE_SECONDS, advanceEnd - asteroidsEnd);
+    addMetric(METRIC_ACCRETIONS, accreted);
+    addMetric(METRIC_COLLISIONS, merged);
+    addMetric(METRIC_STEPS, 1);
+    addMetric(METRIC_SIMULATED_SECONDS, sim->timeStep);
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Splits the asteroids in contiguous ranges, one per thread, and
+ * requests page placement for the next step
+ */
+static void splitRanges(ParallelSim* parallel) {
+    OrbitalSim* sim = parallel->sim;
+    int asteroids = sim->numBodies - sim->systemBodies;
+    int perThread = asteroids / parallel->numThreads;
+    int remainder = asteroids % parallel->numThreads;
+
+    int begin = sim->systemBodies;
+    for (int t = 0; t < parallel->numThreads; t++) {
+        ParallelWorker* worker = &parallel->workers[t];
+        worker->begin = begin;
+        worker->end = begin + perThread + (t < remainder ? 1 : 0);
+        begin = worker->end;
+    }
+
+    parallel->generation = sim->generation;
+    parallel->bodies = sim->bodies;
+    parallel->place = parallel->numa;
+}
+
+/**
+ * @brief Worker thread: waits for a step and computes its range
+ */
+static void runWorker(ParallelSim* parallel, int index) {
+    ParallelWorker* worker = &parallel->workers[index];
+    if (worker->node >= 0 && !bindToNumaNode(worker->node)) {
+        printf("NUMA: cannot bind thread %d to node %d\n", index, worker->node);
+    }
+
+    unsigned int seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(parallel->lock);
+            parallel->wake.wait(guard, [parallel, seen] { return !parallel->running || parallel->step != seen; });
+            if (!parallel->running) return;
+            seen = parallel->step;
+        }
+
+        OrbitalSim* sim = parallel->sim;
+        int count = worker->end - worker->begin;
+
+        // Step scratch sits at the same arena offset every step
+        if (parallel->place && count > 0) {
+            moveToNumaNode(&sim->bodies[worker->begin], sizeof(OrbitalBody) * count, worker->node);
+            moveToNumaNode(&parallel->accelerations[worker->begin], sizeof(Vector3) * count, worker->node);
+        }
+
+        worker->pull = computeAsteroidPull(sim, parallel->accelerations, worker->begin, worker->end);
+
+        std::lock_guard<std::mutex> guard(parallel->lock);
+        if (--parallel->pending == 0) parallel->done.notify_one();
+    }
+}
@@ -0,0 +1,21 @@
+/**
+ * @brief Implements asteroid force computation on a pool of worker threads
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "orbitalSim.h"
+
+#define PARALLEL_MAX_THREADS 64
+
+struct ParallelSim;
+
+ParallelSim* constructParallelSim(OrbitalSim* sim, int threads, bool numa);
+void destroyParallelSim(ParallelSim* parallel);
+void updateParallelSim(ParallelSim* parallel);
+
+#endif
@@ -0,0 +1,459 @@
+/**
+ * @brief Implements Parareal parallel-in-time integration for long horizons
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "hybrid.h"
+#include "metrics.h"
+#include "parareal.h"
+#include "raymath.h"
+
+#define GRAVITATIONAL_CONSTANT 6.6743E-11
+
+/**
+ * @brief Work shared by the fine propagator threads
+ */
+struct PararealWork {
+    OrbitalSim** start;        // Slice initial states U_n
+    OrbitalSim** fine;         // Fine results F(U_n)
+    int* firstEvent;           // Fate events of fine[n] before its slice
+    int slices;
+    int stepsPerSlice;
+    int lastSliceSteps;
+    std::atomic<int> nextSlice;
+};
+
+static int getSliceSteps(int slice, int slices, int stepsPerSlice, int lastSliceSteps);
+static void propagate(OrbitalSim* sim, int steps);
+static void propagateCoarse(OrbitalSim* coarse, const OrbitalSim* start, int sliceSteps);
+static void getSystemBarycenter(const OrbitalSim* sim, double position[3], double velocity[3], double* mass);
+static void runFineSlices(PararealWork* work);
+static bool correctSlice(OrbitalSim* next, const OrbitalSim* coarseNew, const OrbitalSim* fine, const OrbitalSim* coarseOld,
+    float* change);
+static void collectFateEvents(OrbitalSim* sim, int firstEvent, const PararealWork* work);
+static void countAcceptedSteps(const OrbitalSim* sim, int steps, double startTime, int firstEvent, long long computedSteps);
+static Vector3 correctVector(Vector3 coarseNew, Vector3 fine, Vector3 coarseOld);
+static void destroyStates(OrbitalSim** states, int count);
+
+/**
+ * @brief Returns a configuration sized to the machine
+ */
+PararealConfig getDefaultPararealConfig(void) {
+    PararealConfig config;
+    config.slices = 0;
+    config.threads = 0;
+    config.maxIterations = 0;
+    config.tolerance = 1E-4F;
+    return config;
+}
+
+/**
+ * @brief Advances the simulation a number of fine steps using Parareal
+ *
+ * The horizon is split in time slices. A cheap coarse propagator (every body
+ * on its Kepler orbit around the central star over the whole slice) sweeps
+ * the slices serially, while the expensive fine propagator runs every slice
+ * in parallel. Each iteration applies the correction
+ * U[n+1] = G(U[n]) + F(U[n]) - Gold(U[n]), so after k iterations the first k
+ * slices match a serial run exactly. The coarse orbits share the Kepler part
+ * of the motion with the fine ones, so the correction only has to carry the
+ * perturbations, and the iterations contract quickly when those are small.
+ */
+bool pararealOrbitalSim(OrbitalSim* sim, int steps, const PararealConfig* config, PararealStats* stats) {
+    if (!sim || !config || steps <= 0) return false;
+
+    int hardwareThreads = (int)std::thread::hardware_concurrency();
+    if (hardwareThreads < 1) hardwareThreads = 1;
+
+    int slices = (config->slices > 0) ? config->slices : hardwareThreads;
+    if (slices > steps) slices = steps;
+    int threads = (config->threads > 0) ? config->threads : hardwareThreads;
+    if (threads > slices) threads = slices;
+    int maxIterations = (config->maxIterations > 0 && config->maxIterations < slices) ? config->maxIterations : slices;
+
+    int stepsPerSlice = steps / slices;
+    int lastSliceSteps = steps - stepsPerSlice * (slices - 1);
+
+    // Allocate slice states: U[0..slices], Gold[0..slices-1], F[0..slices-1]
+    std::vector<OrbitalSim*> start(slices + 1, (OrbitalSim*)NULL);
+    std::vector<OrbitalSim*> coarseOld(slices, (OrbitalSim*)NULL);
+    std::vector<OrbitalSim*> fine(slices, (OrbitalSim*)NULL);
+    std::vector<int> firstEvents(slices, 0);
+    OrbitalSim* coarse = cloneOrbitalSim(sim);
+
+    bool allocated = (coarse != NULL);
+    for (int n = 0; allocated && n <= slices; n++) {
+        start[n] = cloneOrbitalSim(sim);
+        allocated = (start[n] != NULL);
+        if (allocated && n < slices) {
+            coarseOld[n] = cloneOrbitalSim(sim);
+            fine[n] = cloneOrbitalSim(sim);
+            allocated = coarseOld[n] && fine[n];
+        }
+    }
+
+    if (!allocated) {
+        destroyStates(start.data(), slices + 1);
+        destroyStates(coarseOld.data(), slices);
+        destroyStates(fine.data(), slices);
+        destroyOrbitalSim(coarse);
+        return false;
+    }
+
+    // Corrections mix states of different propagators: no drift tier.
+    // Only the accepted trajectory counts in the metrics.
+    coarse->config.driftSteps = 1;
+    coarse->isTrial = true;
+    for (int n = 0; n <= slices; n++) {
+        start[n]->config.driftSteps = 1;
+        start[n]->isTrial = true;
+        if (n < slices) {
+            coarseOld[n]->config.driftSteps = 1;
+            coarseOld[n]->isTrial = true;
+            fine[n]->config.driftSteps = 1;
+            fine[n]->isTrial = true;
+        }
+    }
+    double startTime = sim->time;
+    int firstEvent = sim->fateEventCount;
+    long long computedSteps = 0;
+
+    // Iteration 0: serial coarse prediction
+    for (int n = 0; n < slices; n++) {
+        int sliceSteps = getSliceSteps(n, slices, stepsPerSlice, lastSliceSteps);
+        propagateCoarse(coarseOld[n], start[n], sliceSteps);
+        copyOrbitalSimState(start[n + 1], coarseOld[n]);
+    }
+
+    PararealWork work;
+    work.start = start.data();
+    work.fine = fine.data();
+    work.firstEvent = firstEvents.data();
+    work.slices = slices;
+    work.stepsPerSlice = stepsPerSlice;
+    work.lastSliceSteps = lastSliceSteps;
+
+    int iterations = 0;
+    float residual = 0.0F;
+    bool converged = false;
+    bool corrected = true;
+
+    for (int k = 0; k < maxIterations && !converged && corrected; k++) {
+        // Fine propagation of every unconverged slice in parallel
+        work.nextSlice = k;
+
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads && t < slices - k; t++) {
+            workers.push_back(std::thread(runFineSlices, &work));
+        }
+        runFineSlices(&work);
+        for (size_t t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+        for (int n = k; n < slices; n++) {
+            computedSteps += getSliceSteps(n, slices, stepsPerSlice, lastSliceSteps);
+        }
+
+        // Serial coarse sweep with correction
+        residual = 0.0F;
+        for (int n = k; n < slices && corrected; n++) {
+            int sliceSteps = getSliceSteps(n, slices, stepsPerSlice, lastSliceSteps);
+            propagateCoarse(coarse, start[n], sliceSteps);
+
+            float change = 0.0F;
+            corrected = correctSlice(start[n + 1], coarse, fine[n], coarseOld[n], &change);
+            if (change > residual) residual = change;
+
+            copyOrbitalSimState(coarseOld[n], coarse);
+        }
+
+        // After as many iterations as slices the result is the serial one,
+        // but it only counts as converged if the corrections settled
+        iterations = k + 1;
+        converged = (residual < config->tolerance);
+    }
+
+    corrected = corrected && copyOrbitalSimState(sim, start[slices]);
+    if (corrected) {
+        collectFateEvents(sim, firstEvent, &work);
+        countAcceptedSteps(sim, steps, startTime, firstEvent, computedSteps);
+    }
+
+    if (stats) {
+        stats->slices = slices;
+        stats->iterations = iterations;
+        stats->residual = residual;
+        stats->converged = converged;
+    }
+
+    destroyStates(start.data(), slices + 1);
+    destroyStates(coarseOld.data(), slices);
+    destroyStates(fine.data(), slices);
+    destroyOrbitalSim(coarse);
+
+    return corrected;
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Number of fine steps in a slice (the last one takes the remainder)
+ */
+static int getSliceSteps(int slice, int slices, int stepsPerSlice, int lastSliceSteps) {
+    return (slice == slices - 1) ? lastSliceSteps : stepsPerSlice;
+}
+
+/**
+ * @brief Runs a number of timesteps on a simulation
+ */
+static void propagate(OrbitalSim* sim, int steps) {
+    for (int i = 0; i < steps; i++) {
+        updateOrbitalSim(sim);
+    }
+}
+
+/**
+ * @brief Coarse propagator: one Kepler drift per body around the central
+ * star (bodies[0]) over the whole slice, in double precision. The system
+ * barycenter moves in a straight line and the star is placed so that it
+ * stays there (a binary star is then exact); in the heliocentric frame the
+ * star stays at the origin. The black hole moves in a straight line. Moons
+ * and rings are left as they are: the correction takes them from the fine
+ * solution.
+ *
+ * The fine integrator stores the semi-implicit Euler velocity, half a kick
+ * behind the true one, so it is converted before and after the drift.
+ */
+static void propagateCoarse(OrbitalSim* coarse, const OrbitalSim* start, int sliceSteps) {
+    copyOrbitalSimState(coarse, start);
+
+    OrbitalBody* bodies = coarse->bodies;
+    double dt = (double)sliceSteps * coarse->timeStep;
+    double halfStep = 0.5 * coarse->timeStep;
+    coarse->time += dt;
+
+    BlackHole* blackHole = &coarse->blackHole;
+    if (blackHole->isActive) {
+        blackHole->position = Vector3Add(blackHole->position, Vector3Scale(blackHole->velocity, (float)dt));
+    }
+
+    if (!bodies[0].isAlive) {
+        for (int i = 1; i < coarse->numBodies; i++) {
+            bodies[i].position = Vector3Add(bodies[i].position, Vector3Scale(bodies[i].velocity, (float)dt));
+        }
+        return;
+    }
+
+    double barycenter[3], barycenterVelocity[3], totalMass;
+    getSystemBarycenter(coarse, barycenter, barycenterVelocity, &totalMass);
+
+    Vector3 center = bodies[0].position;
+    Vector3 centerVelocity = bodies[0].velocity;
+    double centerMu = GRAVITATIONAL_CONSTANT * bodies[0].mass;
+    double shift[3] = { 0.0, 0.0, 0.0 };      // Mass-weighted positions relative to the star
+    double shiftVelocity[3] = { 0.0, 0.0, 0.0 };
+
+    for (int i = 1; i < coarse->numBodies; i++) {
+        OrbitalBody* body = &bodies[i];
+        if (!body->isAlive) continue;
+
+        double position[3] = { (double)body->position.x - center.x, (double)body->position.y - center.y,
+            (double)body->position.z - center.z };
+        double velocity[3] = { (double)body->velocity.x - centerVelocity.x, (double)body->velocity.y - centerVelocity.y,
+            (double)body->velocity.z - centerVelocity.z };
+
+        double distance = sqrt(position[0] * position[0] + position[1] * position[1] + position[2] * position[2]);
+        double kick = (distance > 0.0) ? halfStep * centerMu / (distance * distance * distance) : 0.0;
+        for (int k = 0; k < 3; k++) velocity[k] -= kick * position[k];
+
+        keplerDrift(position, velocity, GRAVITATIONAL_CONSTANT * (bodies[0].mass + body->mass), dt);
+
+        distance = sqrt(position[0] * position[0] + position[1] * position[1] + position[2] * position[2]);
+        kick = (distance > 0.0) ? halfStep * centerMu / (distance * distance * distance) : 0.0;
+        for (int k = 0; k < 3; k++) velocity[k] += kick * position[k];
+
+        if (i < coarse->systemBodies) {
+            for (int k = 0; k < 3; k++) {
+                shift[k] += body->mass * position[k];
+                shiftVelocity[k] += body->mass * velocity[k];
+            }
+        }
+        body->position = { (float)position[0], (float)position[1], (float)position[2] };
+        body->velocity = { (float)velocity[0], (float)velocity[1], (float)velocity[2] };
+    }
+
+    // New star state, then every body back from star-relative coordinates
+    if (coarse->config.frame != FRAME_HELIOCENTRIC) {
+        for (int k = 0; k < 3; k++) {
+            barycenter[k] += barycenterVelocity[k] * dt;
+        }
+        center = { (float)(barycenter[0] - shift[0] / totalMass), (float)(barycenter[1] - shift[1] / totalMass),
+            (float)(barycenter[2] - shift[2] / totalMass) };
+        centerVelocity = { (float)(barycenterVelocity[0] - shiftVelocity[0] / totalMass),
+            (float)(barycenterVelocity[1] - shiftVelocity[1] / totalMass),
+            (float)(barycenterVelocity[2] - shiftVelocity[2] / totalMass) };
+        bodies[0].position = center;
+        bodies[0].velocity = centerVelocity;
+    }
+    for (int i = 1; i < coarse->numBodies; i++) {
+        if (!bodies[i].isAlive) continue;
+        bodies[i].position = Vector3Add(bodies[i].position, center);
+        bodies[i].velocity = Vector3Add(bodies[i].velocity, centerVelocity);
+    }
+}
+
+/**
+ * @brief Barycenter of the alive system bodies (the asteroids do not pull on
+ * them)
+ */
+static void getSystemBarycenter(const OrbitalSim* sim, double position[3], double velocity[3], double* mass) {
+    double total = 0.0;
+    for (int k = 0; k < 3; k++) {
+        position[k] = 0.0;
+        velocity[k] = 0.0;
+    }
+
+    for (int i = 0; i < sim->systemBodies; i++) {
+        const OrbitalBody* body = &sim->bodies[i];
+        if (!body->isAlive) continue;
+
+        position[0] += body->mass * body->position.x;
+        position[1] += body->mass * body->position.y;
+        position[2] += body->mass * body->position.z;
+        velocity[0] += body->mass * body->velocity.x;
+        velocity[1] += body->mass * body->velocity.y;
+        velocity[2] += body->mass * body->velocity.z;
+        total += body->mass;
+    }
+
+    for (int k = 0; k < 3; k++) {
+        position[k] /= total;
+        velocity[k] /= total;
+    }
+    *mass = total;
+}
+
+/**
+ * @brief Fine propagator worker: takes slices until none are left
+ */
+static void runFineSlices(PararealWork* work) {
+    for (;;) {
+        int n = work->nextSlice++;
+        if (n >= work->slices) return;
+
+        copyOrbitalSimState(work->fine[n], work->start[n]);
+        work->firstEvent[n] = work->fine[n]->fateEventCount;
+        propagate(work->fine[n], getSliceSteps(n, work->slices, work->stepsPerSlice, work->lastSliceSteps));
+    }
+}
+
+/**
+ * @brief Applies the Parareal correction to a slice end state
+ *
+ * Body and black hole positions and velocities are corrected; everything
+ * else (alive flags, accreted mass, fate events, moons, rings) is taken from
+ * the fine solution. Sets the RMS relative position change; returns false if
+ * the fate events do not fit in memory.
+ */
+static bool correctSlice(OrbitalSim* next, const OrbitalSim* coarseNew, const OrbitalSim* fine, const OrbitalSim* coarseOld,
+    float* change) {
+    double sumSquares = 0.0;
+    int counted = 0;
+
+    // Change against the previous iterate, before it is overwritten. A body
+    // alive in only one of them (swallowed or ejected from a state that was
+    // still moving), or with a change as large as its position (or not
+    // finite, from a drift of a state far off), counts as a full change.
+    for (int i = 0; i < next->numBodies; i++) {
+        bool wasAlive = next->bodies[i].isAlive;
+        bool isAlive = fine->bodies[i].isAlive;
+        if (!wasAlive && !isAlive) continue;
+
+        float bodyChange = 1.0F;
+        if (wasAlive && isAlive) {
+            Vector3 position = correctVector(coarseNew->bodies[i].position, fine->bodies[i].position, coarseOld->bodies[i].position);
+            float scale = fmaxf(Vector3Length(position), 1.0F);
+            bodyChange = Vector3Distance(position, next->bodies[i].position) / scale;
+            if (!(bodyChange < 1.0F)) bodyChange = 1.0F;
+        }
+        sumSquares += (double)bodyChange * bodyChange;
+        counted++;
+    }
+    *change = (counted > 0) ? (float)sqrt(sumSquares / counted) : 0.0F;
+
+    if (!copyOrbitalSimState(next, fine)) return false;
+
+    for (int i = 0; i < next->numBodies; i++) {
+        OrbitalBody* body = &next->bodies[i];
+        if (!body->isAlive) continue;
+
+        body->position = correctVector(coarseNew->bodies[i].position, fine->bodies[i].position, coarseOld->bodies[i].position);
+        body->velocity = correctVector(coarseNew->bodies[i].velocity, fine->bodies[i].velocity, coarseOld->bodies[i].velocity);
+    }
+    if (next->blackHole.isActive) {
+        next->blackHole.position = correctVector(coarseNew->blackHole.position, fine->blackHole.position, coarseOld->blackHole.position);
+        next->blackHole.velocity = correctVector(coarseNew->blackHole.velocity, fine->blackHole.velocity, coarseOld->blackHole.velocity);
+    }
+    return true;
+}
+
+/**
+ * @brief Parareal update for a single vector: F + (G_new - G_old), which is
+ * exactly F once the slice start stops changing
+ */
+static Vector3 correctVector(Vector3 coarseNew, Vector3 fine, Vector3 coarseOld) {
+    return Vector3Add(fine, Vector3Subtract(coarseNew, coarseOld));
+}
+
+/**
+ * @brief Replaces the fate events of the run with those of the last fine
+ * propagation of each slice, the one its accepted end state comes from (the
+ * slice start states may carry events of earlier iterations)
+ */
+static void collectFateEvents(OrbitalSim* sim, int firstEvent, const PararealWork* work) {
+    sim->fateEventCount = firstEvent;
+    sim->stepEventBegin = firstEvent;
+
+    for (int n = 0; n < work->slices; n++) {
+        const OrbitalSim* fine = work->fine[n];
+        for (int i = work->firstEvent[n]; i < fine->fateEventCount; i++) {
+            recordFateEvent(sim, &fine->fateEvents[i]);
+        }
+    }
+}
+
+/**
+ * @brief Counts the accepted trajectory in the metrics as a serial run would
+ * (the copies count nothing) and the rest of the work apart
+ */
+static void countAcceptedSteps(const OrbitalSim* sim, int steps, double startTime, int firstEvent, long long computedSteps) {
+    int accreted = 0;
+    int merged = 0;
+    for (int i = firstEvent; i < sim->fateEventCount; i++) {
+        if (sim->fateEvents[i].fate == BODY_FATE_ACCRETED) accreted++;
+        if (sim->fateEvents[i].fate == BODY_FATE_MERGED) merged++;
+    }
+
+    addMetric(METRIC_ACCRETIONS, accreted);
+    addMetric(METRIC_COLLISIONS, merged);
+    addMetric(METRIC_STEPS, steps);
+    addMetric(METRIC_SIMULATED_SECONDS, sim->time - startTime);
+    addMetric(METRIC_PARAREAL_EXTRA_STEPS, (double)(computedSteps - steps));
+}
+
+/**
+ * @brief Destroys an array of (possibly partially allocated) states
+ */
+static void destroyStates(OrbitalSim** states, int count) {
+    for (int i = 0; i < count; i++) {
+        destroyOrbitalSim(states[i]);
+    }
+}
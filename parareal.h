@@ -0,0 +1,36 @@
+/**
+ * @brief Implements Parareal parallel-in-time integration for long horizons
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef PARAREAL_H
+#define PARAREAL_H
+
+#include "orbitalSim.h"
+
+/**
+ * @brief Parareal configuration
+ */
+struct PararealConfig {
+    int slices;        // Number of time slices (0 = one per hardware thread)
+    int threads;       // Worker threads for the fine propagator (0 = hardware threads)
+    int maxIterations; // Maximum Parareal iterations (0 or more than slices = slices)
+    float tolerance;   // RMS relative position change that counts as converged
+};
+
+/**
+ * @brief Parareal run statistics
+ */
+struct PararealStats {
+    int slices;        // Time slices used
+    int iterations;    // Iterations performed (as many as slices: same cost as a serial run)
+    float residual;    // Last relative position change between iterations
+    bool converged;    // Residual dropped below tolerance
+};
+
+PararealConfig getDefaultPararealConfig(void);
+bool pararealOrbitalSim(OrbitalSim* sim, int steps, const PararealConfig* config, PararealStats* stats);
+
+#endif
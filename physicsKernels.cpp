@@ -0,0 +1,316 @@
+/**
+ * @brief Implements the physics kernels built once per instruction set
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * This file is compiled for the baseline of the target, and again by
+ * physicsKernelsAvx2.cpp and physicsKernelsAvx512.cpp with the flags of
+ * those instruction sets (see CMakeLists.txt). Every build exports only its
+ * table of entry points; selectPhysicsKernels picks one at run time. Every
+ * other function, including the inline helpers of the headers, stays local
+ * to its build, so no code of a wider instruction set can be shared with
+ * the baseline at link time.
+ *
+ * The ring loops are branch-free over the coordinate arrays so the compiler
+ * vectorizes them (vectorization is enabled for these files).
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#define _USE_MATH_DEFINES
+#define RAYMATH_STATIC_INLINE // Own copy of the vector helpers in every build
+#define GRAVITATIONAL_CONSTANT 6.6743E-11F
+#define RING_BLOCK 256 // Particles advanced together through every substep
+
+#if defined(PHYSICS_KERNELS_AVX512)
+#define KERNEL_ISA ISA_LEVEL_AVX512
+#define KERNEL_TABLE getAvx512Kernels
+#if !defined(__AVX512F__)
+#define KERNEL_UNAVAILABLE // Built without the AVX-512 flags (not x86)
+#endif
+#elif defined(PHYSICS_KERNELS_AVX2)
+#define KERNEL_ISA ISA_LEVEL_AVX2
+#define KERNEL_TABLE getAvx2Kernels
+#if !defined(__AVX2__)
+#define KERNEL_UNAVAILABLE // Built without the AVX2 flags (not x86)
+#endif
+#else
+#define KERNEL_ISA ISA_LEVEL_SSE2
+#define KERNEL_TABLE getSse2Kernels
+#endif
+
+#include "physicsKernels.h"
+
+#ifdef KERNEL_UNAVAILABLE
+
+const PhysicsKernels* KERNEL_TABLE(void) {
+    return NULL;
+}
+
+#else
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "raymath.h"
+
+namespace {
+#include "forces.h"
+#include "softening.h"
+}
+
+static void computeAsteroidAccelerations(const OrbitalSim* sim, Vector3* accelerations, BlackHole* blackHole,
+    int begin, int end);
+static void computeBlackHoleAccelerations(BlackHole* blackHole, OrbitalBody* bodies, Vector3* accelerations,
+    int begin, int end);
+static void advanceRingParticles(RingSystem* ring, float mu, float h, int substeps);
+template <class InverseCube>
+static void dispatchForceTerms(const OrbitalSim* sim, Vector3* accelerations, int begin, int end);
+template <class InverseCube, class StarTerm, class BodyTerm>
+static void ComputeAsteroidAccelerations(const OrbitalSim* sim, OrbitalBody* bodies, Vector3* accelerations, int begin, int end);
+template <class InverseCube>
+static void ComputeBlackHoleAcceleration(BlackHole* blackHole, OrbitalBody* bodies, Vector3* accelerations, int begin, int end);
+static void ComputeRingAccelerations(const float* __restrict x, const float* __restrict y, const float* __restrict z,
+    float* __restrict ax, float* __restrict ay, float* __restrict az, int count, float mu, float j2R2);
+static void KickRingParticles(float* __restrict v, const float* __restrict a, int count, float dt);
+static void DriftRingParticles(float* __restrict x, const float* __restrict v, int count, float dt);
+
+/**
+ * @brief Entry points of this build
+ */
+const PhysicsKernels* KERNEL_TABLE(void) {
+    static const PhysicsKernels kernels = {
+        KERNEL_ISA,
+        computeAsteroidAccelerations,
+        computeBlackHoleAccelerations,
+        advanceRingParticles
+    };
+    return &kernels;
+}
+
+//***** ENTRY POINTS *****//
+
+/**
+ * @brief Accelerations on the asteroids in [begin, end) with the inverse cube
+ * and the force terms of the configuration, plus the pull of blackHole (if
+ * active) on them and theirs on it
+ */
+static void computeAsteroidAccelerations(const OrbitalSim* sim, Vector3* accelerations, BlackHole* blackHole,
+    int begin, int end) {
+    if (sim->config.fastInverseSqrt) {
+        dispatchForceTerms<FastInverseCube>(sim, accelerations, begin, end);
+        if (blackHole->isActive) {
+            ComputeBlackHoleAcceleration<FastInverseCube>(blackHole, sim->bodies, accelerations, begin, end);
+        }
+    }
+    else {
+        dispatchForceTerms<ExactInverseCube>(sim, accelerations, begin, end);
+        if (blackHole->isActive) {
+            ComputeBlackHoleAcceleration<ExactInverseCube>(blackHole, sim->bodies, accelerations, begin, end);
+        }
+    }
+}
+
+/**
+ * @brief Black hole pull on the bodies in [begin, end), and theirs on it,
+ * always with the exact inverse cube (used for the system bodies)
+ */
+static void computeBlackHoleAccelerations(BlackHole* blackHole, OrbitalBody* bodies, Vector3* accelerations,
+    int begin, int end) {
+    ComputeBlackHoleAcceleration<ExactInverseCube>(blackHole, bodies, accelerations, begin, end);
+}
+
+/**
+ * @brief Advances every particle by substeps leapfrog substeps of h seconds
+ * (kick-drift-kick, second order and symplectic) around a parent of
+ * gravitational parameter mu
+ */
+static void advanceRingParticles(RingSystem* ring, float mu, float h, int substeps) {
+    float j2R2 = 1.5f * ring->j2 * ring->referenceRadius * ring->referenceRadius;
+    float halfH = 0.5f * h;
+
+    float ax[RING_BLOCK];
+    float ay[RING_BLOCK];
+    float az[RING_BLOCK];
+
+    for (int begin = 0; begin < ring->count; begin += RING_BLOCK) {
+        int n = (ring->count - begin < RING_BLOCK) ? ring->count - begin : RING_BLOCK;
+        float* x = ring->x + begin;
+        float* y = ring->y + begin;
+        float* z = ring->z + begin;
+        float* vx = ring->vx + begin;
+        float* vy = ring->vy + begin;
+        float* vz = ring->vz + begin;
+
+        ComputeRingAccelerations(x, y, z, ax, ay, az, n, mu, j2R2);
+        for (int step = 0; step < substeps; step++) {
+            KickRingParticles(vx, ax, n, halfH);
+            KickRingParticles(vy, ay, n, halfH);
+            KickRingParticles(vz, az, n, halfH);
+            DriftRingParticles(x, vx, n, h);
+            DriftRingParticles(y, vy, n, h);
+            DriftRingParticles(z, vz, n, h);
+
+            ComputeRingAccelerations(x, y, z, ax, ay, az, n, mu, j2R2);
+            KickRingParticles(vx, ax, n, halfH);
+            KickRingParticles(vy, ay, n, halfH);
+            KickRingParticles(vz, az, n, halfH);
+        }
+    }
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Picks the asteroid kernel of the enabled force terms
+ */
+template <class InverseCube>
+static void dispatchForceTerms(const OrbitalSim* sim, Vector3* accelerations, int begin, int end) {
+    switch (sim->config.forceTerms & (FORCE_TERM_RELATIVITY | FORCE_TERM_RADIATION)) {
+    case FORCE_TERM_RELATIVITY:
+        ComputeAsteroidAccelerations<InverseCube, RelativityTerm, NoBodyTerm>(sim, sim->bodies, accelerations, begin, end);
+        break;
+    case FORCE_TERM_RADIATION:
+        ComputeAsteroidAccelerations<InverseCube, NoStarTerm, RadiationTerm>(sim, sim->bodies, accelerations, begin, end);
+        break;
+    case FORCE_TERM_RELATIVITY | FORCE_TERM_RADIATION:
+        ComputeAsteroidAccelerations<InverseCube, RelativityTerm, RadiationTerm>(sim, sim->bodies, accelerations, begin, end);
+        break;
+    default:
+        ComputeAsteroidAccelerations<InverseCube, NoStarTerm, NoBodyTerm>(sim, sim->bodies, accelerations, begin, end);
+        break;
+    }
+}
+
+/**
+ * @brief Calculates gravitational accelerations on the asteroids in [begin, end),
+ * plus the StarTerm and BodyTerm of the central star outside its softening
+ */
+template <class InverseCube, class StarTerm, class BodyTerm>
+static void ComputeAsteroidAccelerations(const OrbitalSim* sim, OrbitalBody* bodies, Vector3* accelerations, int begin, int end) {
+    // 1. Initialize asteroid accelerations to zero
+    for (int i = begin; i < end; i++) {
+        accelerations[i] = { 0.0f, 0.0f, 0.0f };
+    }
+
+    // 2. Compute gravitational acceleration from primary star to asteroids
+    int systemBodies = sim->systemBodies;
+    if (end > begin && bodies[0].isAlive) {
+        StarTerms star = getStarTerms(GRAVITATIONAL_CONSTANT * bodies[0].mass, bodies[0].mass);
+
+        // Extra pulls of the Jupiter easter egg and of the second star of Alpha Centauri
+        int companion = -1;
+        if (sim->config.easterEgg == EASTER_EGG_JUPITER_1000X &&
+            sim->config.systemType == SYSTEM_TYPE_SOLAR && sim->numBodies > 5) {
+            companion = 5;
+        }
+        else if (sim->config.systemType == SYSTEM_TYPE_ALPHA_CENTAURI) {
+            companion = 1;
+        }
+
+        for (int i = begin; i < end; i++) {
+            if (!bodies[i].isAlive || bodies[i].tier != BODY_TIER_FULL) continue;
+
+            Vector3 r_vec = Vector3Subtract(bodies[i].position, bodies[0].position);
+            double inverse_cube = InverseCube::get(Vector3LengthSqr(r_vec), MIN_DISTANCE_CUBED);
+            double force_magnitude = GRAVITATIONAL_CONSTANT * bodies[0].mass * inverse_cube;
+            accelerations[i] = Vector3Add(accelerations[i], Vector3Scale(r_vec, -force_magnitude));
+
+            if (inverse_cube < 1.0 / MIN_DISTANCE_CUBED) { // Outside the softening (empty for the default terms)
+                float radius = sim->metadata[i].radius;
+                StarTerm::add(star, r_vec, Vector3Subtract(bodies[i].velocity, bodies[0].velocity), &accelerations[i]);
+                BodyTerm::add(star, r_vec, M_PI * radius * radius / bodies[i].mass, &accelerations[i]);
+            }
+
+            if (companion >= 0) {
+                r_vec = Vector3Subtract(bodies[i].position, bodies[companion].position);
+                force_magnitude = GRAVITATIONAL_CONSTANT * bodies[companion].mass *
+                    InverseCube::get(Vector3LengthSqr(r_vec), MIN_DISTANCE_CUBED);
+                accelerations[i] = Vector3Add(accelerations[i], Vector3Scale(r_vec, -force_magnitude));
+            }
+        }
+    }
+
+    // 3. Compute gravitational acceleration from planets to asteroids (if within influence distance)
+    for (int i = 1; i < systemBodies; i++) { // Skip primary star (index 0)
+        if (!bodies[i].isAlive) continue;
+
+        for (int j = begin; j < end; j++) {
+            if (!bodies[j].isAlive || bodies[j].tier != BODY_TIER_FULL) continue;
+
+            Vector3 r_vec = Vector3Subtract(bodies[j].position, bodies[i].position);
+            double r_squared = Vector3LengthSqr(r_vec);
+
+            if (r_squared < INFLUENCE_DISTANCE_SQ) {
+                double force_magnitude = GRAVITATIONAL_CONSTANT * bodies[i].mass *
+                    InverseCube::get(r_squared, MIN_DISTANCE_CUBED);
+                accelerations[j] = Vector3Add(accelerations[j], Vector3Scale(r_vec, -force_magnitude));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Black hole pull on the bodies in [begin, end), and their pull on it
+ * (a hundredth of it inside the softening)
+ */
+template <class InverseCube>
+static void ComputeBlackHoleAcceleration(BlackHole* blackHole, OrbitalBody* bodies, Vector3* accelerations, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        if (!bodies[i].isAlive || bodies[i].tier != BODY_TIER_FULL) continue;
+
+        Vector3 r_vec = Vector3Subtract(bodies[i].position, blackHole->position);
+        double inverse_cube = InverseCube::get(Vector3LengthSqr(r_vec), MIN_DISTANCE_CUBED);
+        double reaction = (inverse_cube < 1.0 / MIN_DISTANCE_CUBED) ? 1.0 : 0.01;
+
+        // Force on the orbital body (towards the black hole)
+        double force_magnitude_body = GRAVITATIONAL_CONSTANT * blackHole->mass * inverse_cube;
+        accelerations[i] = Vector3Add(accelerations[i], Vector3Scale(r_vec, -force_magnitude_body));
+
+        // Force on the black hole (towards the body)
+        double force_magnitude_blackHole = reaction * GRAVITATIONAL_CONSTANT * bodies[i].mass * inverse_cube;
+        blackHole->acceleration = Vector3Add(blackHole->acceleration, Vector3Scale(r_vec, force_magnitude_blackHole));
+    }
+}
+
+/**
+ * @brief Point mass plus J2 acceleration in the equatorial frame:
+ * a = -mu r / r^3 (1 + 3/2 J2 (R/r)^2 (1 - 5 z^2/r^2)), with 3 instead of 1
+ * for the z component
+ */
+static void ComputeRingAccelerations(const float* __restrict x, const float* __restrict y, const float* __restrict z,
+    float* __restrict ax, float* __restrict ay, float* __restrict az, int count, float mu, float j2R2) {
+    for (int i = 0; i < count; i++) {
+        float r2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        float invR2 = 1.0f / r2;
+        float invR = sqrtf(invR2);
+        float pull = -mu * invR * invR2;
+        float oblateness = j2R2 * invR2;
+        float polar = 5.0f * z[i] * z[i] * invR2;
+
+        float planar = pull * (1.0f + oblateness * (1.0f - polar));
+        ax[i] = planar * x[i];
+        ay[i] = planar * y[i];
+        az[i] = pull * (1.0f + oblateness * (3.0f - polar)) * z[i];
+    }
+}
+
+/**
+ * @brief v += a dt over one coordinate array
+ */
+static void KickRingParticles(float* __restrict v, const float* __restrict a, int count, float dt) {
+    for (int i = 0; i < count; i++) {
+        v[i] += dt * a[i];
+    }
+}
+
+/**
+ * @brief x += v dt over one coordinate array
+ */
+static void DriftRingParticles(float* __restrict x, const float* __restrict v, int count, float dt) {
+    for (int i = 0; i < count; i++) {
+        x[i] += dt * v[i];
+    }
+}
+
+#endif
@@ -0,0 +1,43 @@
+/**
+ * @brief Implements the physics kernels built once per instruction set
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef PHYSICSKERNELS_H
+#define PHYSICSKERNELS_H
+
+#include "orbitalSim.h"
+
+#define INFLUENCE_DISTANCE_SQ 1E15 // Threshold for planet-asteroid interactions
+
+/**
+ * @brief Entry points of one build of the kernels
+ */
+struct PhysicsKernels {
+    IsaLevel isa;
+
+    // Pull of the star, the planets and the black hole (if active) on the
+    // asteroids in [begin, end), adding theirs to blackHole->acceleration
+    void (*asteroidAccelerations)(const OrbitalSim* sim, Vector3* accelerations, BlackHole* blackHole,
+        int begin, int end);
+
+    // Exact black hole pull on the bodies in [begin, end), adding theirs to it
+    void (*blackHoleAccelerations)(BlackHole* blackHole, OrbitalBody* bodies, Vector3* accelerations,
+        int begin, int end);
+
+    // Leapfrog substeps of the ring particles around a parent of parameter mu
+    void (*ringParticles)(RingSystem* ring, float mu, float h, int substeps);
+};
+
+IsaLevel getCpuIsaLevel(void);
+const PhysicsKernels* selectPhysicsKernels(IsaLevel requested);
+const char* getIsaLevelName(IsaLevel level);
+
+// One per build of physicsKernels.cpp, NULL if this binary has no code for it
+const PhysicsKernels* getSse2Kernels(void);
+const PhysicsKernels* getAvx2Kernels(void);
+const PhysicsKernels* getAvx512Kernels(void);
+
+#endif
@@ -0,0 +1,11 @@
+/**
+ * @brief Builds the physics kernels for AVX2 and FMA
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * CMakeLists.txt compiles this file with the flags of that instruction set.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#define PHYSICS_KERNELS_AVX2
+#include "physicsKernels.cpp"
@@ -0,0 +1,11 @@
+/**
+ * @brief Builds the physics kernels for AVX-512 (F, VL, DQ and BW)
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * CMakeLists.txt compiles this file with the flags of that instruction set.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#define PHYSICS_KERNELS_AVX512
+#include "physicsKernels.cpp"
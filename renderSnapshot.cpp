@@ -0,0 +1,164 @@
+/**
+ * @brief Implements a compact quantized snapshot of the bodies for rendering
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "memoryStats.h"
+#include "raymath.h"
+#include "renderSnapshot.h"
+
+#define RENDER_POSITION_LIMIT 2147483000.0F
+
+static int32_t quantizePosition(float value, float origin);
+static uint8_t getPaletteIndex(RenderSnapshot* snapshot, Color color);
+static uint8_t getRadiusClass(float radius);
+
+/**
+ * @brief Constructs an empty snapshot
+ */
+RenderSnapshot* constructRenderSnapshot(void) {
+    RenderSnapshot* snapshot = (RenderSnapshot*)calloc(1, sizeof(RenderSnapshot));
+    return snapshot;
+}
+
+/**
+ * @brief Destroys a snapshot
+ */
+void destroyRenderSnapshot(RenderSnapshot* snapshot) {
+    if (!snapshot) return;
+    addMemoryUsage(MEMORY_SNAPSHOTS, -(long long)sizeof(RenderBody) * snapshot->capacity);
+    free(snapshot->bodies);
+    free(snapshot);
+}
+
+/**
+ * @brief Quantizes the bodies around the camera cell (physics side, once
+ * per frame). Returns false if the snapshot could not grow.
+ */
+bool updateRenderSnapshot(RenderSnapshot* snapshot, const OrbitalSim* sim, Vector3 camera) {
+    int entries = sim->numBodies + sim->numSatellites + sim->rings.count;
+    if (entries > snapshot->capacity) {
+        RenderBody* bodies = (RenderBody*)realloc(snapshot->bodies, sizeof(RenderBody) * entries);
+        if (!bodies) return false;
+        addMemoryUsage(MEMORY_SNAPSHOTS, (long long)sizeof(RenderBody) * (entries - snapshot->capacity));
+        snapshot->bodies = bodies;
+        snapshot->capacity = entries;
+    }
+
+    snapshot->origin = {
+        floorf(camera.x / RENDER_CELL_SIZE) * RENDER_CELL_SIZE,
+        floorf(camera.y / RENDER_CELL_SIZE) * RENDER_CELL_SIZE,
+        floorf(camera.z / RENDER_CELL_SIZE) * RENDER_CELL_SIZE
+    };
+    snapshot->paletteSize = 0;
+    snapshot->count = sim->numBodies;
+    snapshot->satelliteCount = sim->numSatellites;
+    snapshot->ringCount = sim->rings.count;
+    snapshot->systemBodies = sim->systemBodies;
+
+    // Asteroids share their radius: reuse the last class
+    float lastRadius = -1.0f;
+    uint8_t lastClass = 0;
+
+    for (int i = 0; i < sim->numBodies; i++) {
+        const OrbitalBody* body = &sim->bodies[i];
+        const BodyMetadata* metadata = &sim->metadata[i];
+        RenderBody* out = &snapshot->bodies[i];
+
+        out->x = quantizePosition(body->position.x * SCALE_FACTOR, snapshot->origin.x);
+        out->y = quantizePosition(body->position.y * SCALE_FACTOR, snapshot->origin.y);
+        out->z = quantizePosition(body->position.z * SCALE_FACTOR, snapshot->origin.z);
+        out->palette = body->isAlive ? getPaletteIndex(snapshot, metadata->color) : RENDER_HIDDEN;
+        out->reserved = 0;
+
+        if (metadata->radius != lastRadius) {
+            lastClass = getRadiusClass(metadata->radius);
+            lastRadius = metadata->radius;
+        }
+        out->radiusClass = lastClass;
+    }
+
+    // Moons around their planet, with exaggerated orbits
+    for (int s = 0; s < sim->numSubsystems; s++) {
+        const Subsystem* subsystem = &sim->subsystems[s];
+        Vector3 center = Vector3Scale(sim->bodies[subsystem->parent].position, SCALE_FACTOR);
+
+        for (int i = subsystem->first; i < subsystem->first + subsystem->count; i++) {
+            const Satellite* satellite = &sim->satellites[i];
+            RenderBody* out = &snapshot->bodies[sim->numBodies + i];
+            Vector3 position = Vector3Add(center,
+                Vector3Scale(satellite->position, SCALE_FACTOR * SATELLITE_DISPLAY_SCALE));
+
+            out->x = quantizePosition(position.x, snapshot->origin.x);
+            out->y = quantizePosition(position.y, snapshot->origin.y);
+            out->z = quantizePosition(position.z, snapshot->origin.z);
+            out->palette = satellite->isAlive ? getPaletteIndex(snapshot, sim->satelliteMetadata[i].color) : RENDER_HIDDEN;
+            out->radiusClass = getRadiusClass(sim->satelliteMetadata[i].radius);
+            out->reserved = 0;
+        }
+    }
+
+    // Ring particles around their planet, scaled to its drawn radius
+    const RingSystem* rings = &sim->rings;
+    if (rings->count > 0) {
+        const BodyMetadata* parent = &sim->metadata[rings->parent];
+        Vector3 center = Vector3Scale(sim->bodies[rings->parent].position, SCALE_FACTOR);
+        float scale = RADIUS_SCALE(parent->radius) / parent->radius;
+        uint8_t palette = getPaletteIndex(snapshot, rings->color);
+        uint8_t radiusClass = getRadiusClass(RING_PARTICLE_RADIUS);
+
+        RenderBody* out = &snapshot->bodies[sim->numBodies + sim->numSatellites];
+        for (int i = 0; i < rings->count; i++, out++) {
+            Vector3 position = Vector3Add(center, Vector3Scale(getRingParticleOffset(rings, i), scale));
+
+            out->x = quantizePosition(position.x, snapshot->origin.x);
+            out->y = quantizePosition(position.y, snapshot->origin.y);
+            out->z = quantizePosition(position.z, snapshot->origin.z);
+            out->palette = palette;
+            out->radiusClass = radiusClass;
+            out->reserved = 0;
+        }
+    }
+
+    return true;
+}
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Fixed-point offset from the origin, clamped to the int32 range
+ */
+static int32_t quantizePosition(float value, float origin) {
+    float steps = (value - origin) / RENDER_POSITION_QUANTUM;
+    steps = fminf(fmaxf(steps, -RENDER_POSITION_LIMIT), RENDER_POSITION_LIMIT);
+    return (int32_t)lrintf(steps);
+}
+
+/**
+ * @brief Drawn radius of a body in RENDER_RADIUS_QUANTUM units
+ */
+static uint8_t getRadiusClass(float radius) {
+    float radiusClass = roundf(RADIUS_SCALE(radius) / RENDER_RADIUS_QUANTUM);
+    return (uint8_t)fminf(fmaxf(radiusClass, 0.0f), 255.0f);
+}
+
+/**
+ * @brief Palette entry of a color, added on first use. Bodies come in runs
+ * of the same color, so the last entry is checked first.
+ */
+static uint8_t getPaletteIndex(RenderSnapshot* snapshot, Color color) {
+    int last = snapshot->paletteSize - 1;
+    for (int i = last; i >= 0; i--) {
+        Color entry = snapshot->palette[i];
+        if (entry.r == color.r && entry.g == color.g && entry.b == color.b && entry.a == color.a) return (uint8_t)i;
+    }
+
+    if (snapshot->paletteSize == RENDER_PALETTE_SIZE) return 0; // Full: reuse the first color
+    snapshot->palette[snapshot->paletteSize] = color;
+    return (uint8_t)snapshot->paletteSize++;
+}
@@ -0,0 +1,69 @@
+/**
+ * @brief Implements a compact quantized snapshot of the bodies for rendering
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include "orbitalSim.h"
+
+// Scene scale shared by the physics side and the view
+#define SCALE_FACTOR 1E-11F
+#define RADIUS_SCALE(r) (0.005F * logf(r))
+#define SATELLITE_DISPLAY_SCALE 60.0F // Moon orbits are drawn larger to clear the planet spheres
+
+#define RENDER_CELL_SIZE 64.0F                   // Camera cell [scene units]
+#define RENDER_POSITION_QUANTUM (1.0F / 65536)   // [scene units], range +-32768
+#define RENDER_RADIUS_QUANTUM 0.001F             // [scene units]
+#define RENDER_PALETTE_SIZE 255
+#define RENDER_HIDDEN 255                        // Palette index of dead bodies
+
+/**
+ * @brief One body, 16 bytes instead of a full OrbitalBody
+ */
+struct RenderBody {
+    int32_t x, y, z;       // Scene position relative to the snapshot origin
+    uint8_t palette;       // Index in RenderSnapshot.palette, RENDER_HIDDEN if dead
+    uint8_t radiusClass;   // RADIUS_SCALE(radius) / RENDER_RADIUS_QUANTUM
+    uint16_t reserved;
+};
+
+/**
+ * @brief Everything the view needs to draw the bodies of one frame.
+ * bodies[i] matches sim->bodies[i]; the satellites and then the ring
+ * particles follow them.
+ */
+struct RenderSnapshot {
+    Vector3 origin;        // Camera cell corner [scene units]
+    Color palette[RENDER_PALETTE_SIZE];
+    int paletteSize;
+    RenderBody* bodies;
+    int count;
+    int satelliteCount;    // Entries after count are moons
+    int ringCount;         // Entries after the moons are ring particles
+    int systemBodies;      // The first systemBodies entries are planets/stars
+    int capacity;
+};
+
+RenderSnapshot* constructRenderSnapshot(void);
+void destroyRenderSnapshot(RenderSnapshot* snapshot);
+bool updateRenderSnapshot(RenderSnapshot* snapshot, const OrbitalSim* sim, Vector3 camera);
+
+/**
+ * @brief Scene position of a snapshot body
+ */
+static inline Vector3 getRenderPosition(const RenderSnapshot* snapshot, const RenderBody* body) {
+    return {
+        snapshot->origin.x + body->x * RENDER_POSITION_QUANTUM,
+        snapshot->origin.y + body->y * RENDER_POSITION_QUANTUM,
+        snapshot->origin.z + body->z * RENDER_POSITION_QUANTUM
+    };
+}
+
+#endif
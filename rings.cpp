@@ -0,0 +1,22 @@
+/**
+ * @brief Implements planetary ring particles integrated in the planet frame
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * The particles only feel the parent (point mass plus J2), so they are
+ * advanced in blocks that stay in L1 for every substep, by the ring kernel
+ * of physicsKernels.cpp.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include "rings.h"
+#include "raymath.h"
+
+/**
+ * @brief Position of a particle relative to the parent, in simulation axes
+ */
+Vector3 getRingParticleOffset(const RingSystem* ring, int index) {
+    Vector3 offset = Vector3Scale(ring->axes[0], ring->x[index]);
+    offset = Vector3Add(offset, Vector3Scale(ring->axes[1], ring->y[index]));
+    return Vector3Add(offset, Vector3Scale(ring->axes[2], ring->z[index]));
+}
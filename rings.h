@@ -0,0 +1,38 @@
+/**
+ * @brief Implements planetary ring particles integrated in the planet frame
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef RINGS_H
+#define RINGS_H
+
+#include "raylib.h"
+
+#define RING_PARTICLE_RADIUS 2E3F // Drawn radius [m], like an asteroid
+
+/**
+ * @brief Test particles around one system body, stored as arrays (one per
+ * coordinate) in the parent equatorial frame: z along the spin axis
+ */
+struct RingSystem {
+    int parent;              // Index in bodies, -1 without rings
+    int count;
+    float* x;                // Positions relative to the parent [m] (carved from arena)
+    float* y;
+    float* z;
+    float* vx;               // Velocities relative to the parent [m/s] (carved from arena)
+    float* vy;
+    float* vz;
+    Vector3 axes[3];         // Equatorial frame in simulation axes (x, y, spin axis)
+    float j2;                // Oblateness coefficient of the parent
+    float referenceRadius;   // J2 reference radius [m]
+    float innerRadius;       // Innermost particle distance at creation [m]
+    int substeps;            // Substeps of the last step
+    Color color;
+};
+
+Vector3 getRingParticleOffset(const RingSystem* ring, int index);
+
+#endif
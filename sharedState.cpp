@@ -0,0 +1,286 @@
+/**
+ * @brief Publishes the simulation state in POSIX shared memory
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+#include "memoryStats.h"
+#include "sharedState.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SHARED_STATE_READ_RETRIES 64
+
+static size_t getSegmentSize(int capacity);
+static void setSegmentName(SharedState* state, const char* name);
+
+#ifndef _WIN32
+
+static bool mapSegment(SharedState* state, size_t size);
+static void unmapSegment(SharedState* state);
+
+/**
+ * @brief Creates (or replaces) a shared memory segment for publishing
+ */
+SharedState* constructSharedState(const char* name, int capacity) {
+    if (!name || capacity < 0) return NULL;
+
+    SharedState* state = (SharedState*)calloc(1, sizeof(SharedState));
+    if (!state) return NULL;
+
+    setSegmentName(state, name);
+    state->isWriter = true;
+
+    // A previous run may have left a stale segment behind
+    shm_unlink(state->name);
+    state->fd = shm_open(state->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (state->fd < 0) {
+        perror("shm_open");
+        free(state);
+        return NULL;
+    }
+
+    size_t size = getSegmentSize(capacity);
+    if (ftruncate(state->fd, (off_t)size) != 0 || !mapSegment(state, size)) {
+        perror("shared state");
+        close(state->fd);
+        shm_unlink(state->name);
+        free(state);
+        return NULL;
+    }
+
+    SharedStateHeader* header = state->header;
+    memset((void*)header, 0, sizeof(SharedStateHeader));
+    header->magic = SHARED_STATE_MAGIC;
+    header->version = SHARED_STATE_VERSION;
+    header->capacity = (uint32_t)capacity;
+    header->sequence.store(0, std::memory_order_release);
+
+    return state;
+}
+
+/**
+ * @brief Unmaps a segment. The writer also removes its name.
+ */
+void destroySharedState(SharedState* state) {
+    if (!state) return;
+
+    unmapSegment(state);
+    if (state->fd >= 0) close(state->fd);
+    if (state->isWriter) shm_unlink(state->name);
+    free(state);
+}
+
+/**
+ * @brief Publishes the current simulation state (writer side)
+ *
+ * The copy is a plain memcpy-sized loop bracketed by the seqlock, so the
+ * simulation never waits for readers.
+ */
+bool publishSharedState(SharedState* state, const OrbitalSim* sim) {
+    if (!state || !state->isWriter || !state->header || !sim) return false;
+
+    SharedStateHeader* header = state->header;
+    uint32_t sequence = header->sequence.load(std::memory_order_relaxed);
+
+    header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Grow the segment if the simulation was reset with more bodies
+    if ((uint32_t)sim->numBodies > header->capacity) {
+        size_t size = getSegmentSize(sim->numBodies);
+        if (ftruncate(state->fd, (off_t)size) != 0) {
+            header->sequence.store(sequence + 2, std::memory_order_release);
+            return false;
+        }
+        // Map the grown segment before dropping the old mapping: if that
+        // fails, the writer and its readers stay on the old one
+        SharedState old = *state;
+        if (!mapSegment(state, size)) {
+            *state = old;
+            header->sequence.store(sequence + 2, std::memory_order_release);
+            return false;
+        }
+        unmapSegment(&old);
+
+        header = state->header;
+        header->capacity = (uint32_t)sim->numBodies;
+    }
+
+    header->info.numBodies = (uint32_t)sim->numBodies;
+    header->info.systemBodies = (uint32_t)sim->systemBodies;
+    header->info.time = sim->time;
+    header->info.timeStep = sim->timeStep;
+    header->info.frameOrigin = sim->frameOrigin;
+    header->info.frameVelocity = sim->frameVelocity;
+
+    SharedBlackHoleState* blackHole = &header->info.blackHole;
+    blackHole->position = sim->blackHole.position;
+    blackHole->velocity = sim->blackHole.velocity;
+    blackHole->mass = sim->blackHole.mass;
+    blackHole->radius = sim->blackHole.radius;
+    blackHole->isActive = sim->blackHole.isActive;
+
+    SharedBodyState* bodies = state->bodies;
+    for (int i = 0; i < sim->numBodies; i++) {
+        bodies[i].position = sim->bodies[i].position;
+        bodies[i].velocity = sim->bodies[i].velocity;
+        bodies[i].mass = sim->bodies[i].mass;
+        bodies[i].isAlive = sim->bodies[i].isAlive;
+    }
+
+    header->sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Opens an existing segment for reading
+ */
+SharedState* openSharedState(const char* name) {
+    if (!name) return NULL;
+
+    SharedState* state = (SharedState*)calloc(1, sizeof(SharedState));
+    if (!state) return NULL;
+
+    setSegmentName(state, name);
+    state->isWriter = false;
+    state->fd = shm_open(state->name, O_RDONLY, 0);
+    if (state->fd < 0) {
+        free(state);
+        return NULL;
+    }
+
+    if (!mapSegment(state, getSegmentSize(0)) ||
+        state->header->magic != SHARED_STATE_MAGIC ||
+        state->header->version != SHARED_STATE_VERSION) {
+        destroySharedState(state);
+        return NULL;
+    }
+
+    return state;
+}
+
+/**
+ * @brief Copies a consistent snapshot out of the segment (reader side)
+ *
+ * Returns the number of bodies copied, or -1 if the writer kept the
+ * segment busy for every retry.
+ */
+int readSharedState(SharedState* state, SharedStateInfo* info, SharedBodyState* bodies, int maxBodies) {
+    if (!state || !info) return -1;
+
+    for (int attempt = 0; attempt < SHARED_STATE_READ_RETRIES; attempt++) {
+        uint32_t before = state->header->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Follow the writer if it grew the segment
+        uint32_t capacity = state->header->capacity;
+        if (getSegmentSize(capacity) > state->mappedSize) {
+            unmapSegment(state);
+            if (!mapSegment(state, getSegmentSize(capacity))) return -1;
+            continue;
+        }
+
+        *info = state->header->info;
+        int count = (int)info->numBodies;
+        if (count > (int)capacity) count = (int)capacity;
+        if (count > maxBodies) count = maxBodies;
+        if (bodies && count > 0) {
+            memcpy(bodies, state->bodies, sizeof(SharedBodyState) * count);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t after = state->header->sequence.load(std::memory_order_relaxed);
+        if (before == after) return count;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Maps the segment with the access mode of its side
+ */
+static bool mapSegment(SharedState* state, size_t size) {
+    int protection = state->isWriter ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* address = mmap(NULL, size, protection, MAP_SHARED, state->fd, 0);
+    if (address == MAP_FAILED) {
+        state->header = NULL;
+        state->bodies = NULL;
+        state->mappedSize = 0;
+        return false;
+    }
+
+    state->header = (SharedStateHeader*)address;
+    state->bodies = (SharedBodyState*)((char*)address + sizeof(SharedStateHeader));
+    state->mappedSize = size;
+    addMemoryUsage(MEMORY_SNAPSHOTS, (long long)size);
+    return true;
+}
+
+/**
+ * @brief Unmaps the segment
+ */
+static void unmapSegment(SharedState* state) {
+    if (state->header) munmap((void*)state->header, state->mappedSize);
+    addMemoryUsage(MEMORY_SNAPSHOTS, -(long long)state->mappedSize);
+    state->header = NULL;
+    state->bodies = NULL;
+    state->mappedSize = 0;
+}
+
+#else
+
+// POSIX shared memory is not available: publishing is disabled
+
+SharedState* constructSharedState(const char* name, int capacity) {
+    printf("Shared memory publication is not supported on this platform\n");
+    return NULL;
+}
+
+void destroySharedState(SharedState* state) {
+    free(state);
+}
+
+bool publishSharedState(SharedState* state, const OrbitalSim* sim) {
+    return false;
+}
+
+SharedState* openSharedState(const char* name) {
+    return NULL;
+}
+
+int readSharedState(SharedState* state, SharedStateInfo* info, SharedBodyState* bodies, int maxBodies) {
+    return -1;
+}
+
+#endif
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Segment size for a body capacity
+ */
+static size_t getSegmentSize(int capacity) {
+    return sizeof(SharedStateHeader) + sizeof(SharedBodyState) * (size_t)capacity;
+}
+
+/**
+ * @brief Stores the segment name with the leading slash POSIX expects
+ */
+static void setSegmentName(SharedState* state, const char* name) {
+    snprintf(state->name, sizeof(state->name), "%s%s", (name[0] == '/') ? "" : "/", name);
+}
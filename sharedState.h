@@ -0,0 +1,91 @@
+/**
+ * @brief Publishes the simulation state in POSIX shared memory
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef SHAREDSTATE_H
+#define SHAREDSTATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#include "orbitalSim.h"
+
+#define SHARED_STATE_MAGIC 0x4F524253 // "ORBS"
+#define SHARED_STATE_VERSION 2
+
+/**
+ * @brief Body record as seen by external readers
+ */
+struct SharedBodyState {
+    Vector3 position;   // [m]
+    Vector3 velocity;   // [m/s]
+    double mass;        // [kg]
+    int32_t isAlive;
+    int32_t reserved;
+};
+
+/**
+ * @brief Black hole record as seen by external readers
+ */
+struct SharedBlackHoleState {
+    Vector3 position;
+    Vector3 velocity;
+    double mass;
+    double radius;
+    int32_t isActive;
+    int32_t reserved;
+};
+
+/**
+ * @brief Per-publication simulation summary
+ */
+struct SharedStateInfo {
+    uint32_t numBodies;
+    uint32_t systemBodies;
+    double time;             // Simulated time [s]
+    double timeStep;         // [s]
+    Vector3 frameOrigin;     // Positions are relative to it (ephemeris frame, 0 unless heliocentric)
+    Vector3 frameVelocity;   // Velocities are relative to it
+    SharedBlackHoleState blackHole;
+};
+
+/**
+ * @brief Segment header. The body array follows it in the segment.
+ *
+ * sequence is a seqlock: odd while the writer is updating, even otherwise.
+ * Readers copy the payload and retry if the sequence changed meanwhile.
+ */
+struct SharedStateHeader {
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> sequence;
+    uint32_t capacity;       // Body records the segment can hold
+    SharedStateInfo info;
+};
+
+/**
+ * @brief Shared memory segment handle (writer or reader side)
+ */
+struct SharedState {
+    char name[64];
+    int fd;
+    SharedStateHeader* header;
+    SharedBodyState* bodies;
+    size_t mappedSize;
+    bool isWriter;
+};
+
+// Writer side (the simulation)
+SharedState* constructSharedState(const char* name, int capacity);
+void destroySharedState(SharedState* state);
+bool publishSharedState(SharedState* state, const OrbitalSim* sim);
+
+// Reader side (external consumers)
+SharedState* openSharedState(const char* name);
+int readSharedState(SharedState* state, SharedStateInfo* info, SharedBodyState* bodies, int maxBodies);
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @brief Implements the softened inverse cube shared by the gravity kernels
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * Every pull is G m r / max(r^3, minCubed): outside the softening radius it
+ * is Newtonian, inside it falls linearly to zero instead of diverging. The
+ * max compiles to a single instruction, so a kernel has one code path per
+ * pair, without branches, and vectorizes. The inverse cube is a policy of
+ * the kernels, like the force terms: exact by default, or from a fast
+ * reciprocal square root.
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef SOFTENING_H
+#define SOFTENING_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MIN_DISTANCE_CUBED 1E29 // Softening of the gravity kernels [m^3] (~4.6E9 m)
+
+/**
+ * @brief 1 / sqrt(x) from the bit pattern of x and two Newton steps.
+ * Relative error below 4.8E-6 for any normal x (1.8E-3 after the first
+ * step, squared by the second).
+ */
+static inline float FastInverseSqrt(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5F375A86 - (bits >> 1);
+    float y;
+    memcpy(&y, &bits, sizeof(y));
+
+    float half = 0.5f * x;
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+    return y;
+}
+
+/**
+ * @brief 1 / max(r^3, minCubed) with a correctly rounded square root
+ */
+struct ExactInverseCube {
+    static inline double get(double rSquared, double minCubed) {
+        double rCubed = rSquared * sqrt(rSquared);
+        return 1.0 / (rCubed > minCubed ? rCubed : minCubed);
+    }
+};
+
+/**
+ * @brief 1 / max(r^3, minCubed) from FastInverseSqrt: relative error below
+ * 1.5E-5 (three times that of the square root), no square root or division
+ * per pair. rSquared is rounded to float first. Meant for targets without a
+ * fast hardware square root and division: on x86 the exact one costs the same.
+ */
+struct FastInverseCube {
+    static inline double get(double rSquared, double minCubed) {
+        float y = FastInverseSqrt((float)rSquared);
+        float inverseCube = y * y * y;
+        float maxInverseCube = (float)(1.0 / minCubed);
+        return inverseCube < maxInverseCube ? inverseCube : maxInverseCube;
+    }
+};
+
+#endif
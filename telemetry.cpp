@@ -0,0 +1,640 @@
+/**
+ * @brief Implements a loopback HTTP/WebSocket telemetry endpoint
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "memoryStats.h"
+#include "metrics.h"
+#include "telemetry.h"
+
+/**
+ * @brief Body record of a snapshot
+ */
+struct TelemetryRecord {
+    uint32_t index;
+    Vector3 position;
+};
+
+/**
+ * @brief Snapshot built on the simulation thread, serialized on the server thread
+ */
+struct TelemetrySnapshot {
+    double time;
+    int numBodies;
+    int aliveBodies;
+    TelemetryStats stats;
+    bool blackHoleActive;
+    Vector3 blackHolePosition;
+    double blackHoleMass;
+    Vector3 frameOrigin;
+    int count;
+    TelemetryRecord* records;
+};
+
+#ifndef _WIN32
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define TELEMETRY_MAX_CLIENTS 16
+#define TELEMETRY_REQUEST_SIZE 2048
+#define TELEMETRY_POLL_MS 20
+
+/**
+ * @brief Connected client
+ */
+struct TelemetryClient {
+    int fd;
+    bool isWebSocket;
+    char request[TELEMETRY_REQUEST_SIZE];
+    int requestLength;
+};
+
+/**
+ * @brief Server state
+ *
+ * Snapshots rotate through three buffers: the simulation fills "back", swaps it
+ * with "pending" under the lock, and the server swaps "pending" with "front".
+ * Neither side allocates or waits on the other.
+ */
+struct TelemetryServer {
+    int listener;
+    int maxBodies;
+    double interval;         // Seconds between snapshots
+    double lastPublish;
+
+    TelemetrySnapshot buffers[3];
+    MemoryAccount memory;
+    TelemetrySnapshot* back;
+    TelemetrySnapshot* pending;
+    TelemetrySnapshot* front;
+    bool hasPending;
+    std::mutex lock;
+
+    TelemetryClient clients[TELEMETRY_MAX_CLIENTS];
+    int numClients;
+    std::vector<unsigned char> frame;
+
+    std::atomic<bool> running;
+    std::thread thread;
+};
+
+static void runServer(TelemetryServer* server);
+static void acceptClient(TelemetryServer* server);
+static bool serviceClient(TelemetryServer* server, TelemetryClient* client);
+static bool handleRequest(TelemetryServer* server, TelemetryClient* client);
+static void removeClient(TelemetryServer* server, int index);
+static void broadcastSnapshot(TelemetryServer* server, const TelemetrySnapshot* snapshot);
+static size_t encodeSnapshot(const TelemetrySnapshot* snapshot, std::vector<unsigned char>& out, size_t offset);
+static bool sendAll(int fd, const void* data, size_t size);
+static bool sendText(int fd, const char* status, const char* contentType, const char* body);
+static void computeWebSocketAccept(const char* key, char* accept);
+static void sha1(const unsigned char* data, size_t size, unsigned char digest[20]);
+static void base64(const unsigned char* data, size_t size, char* out);
+static double getWallTime(void);
+
+/**
+ * @brief Starts the server thread on 127.0.0.1:port
+ */
+TelemetryServer* constructTelemetryServer(int port, float rate, int maxBodies) {
+    if (port <= 0 || rate <= 0.0f || maxBodies < 0) return NULL;
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("socket");
+        return NULL;
+    }
+
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((uint16_t)port);
+
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 4) != 0) {
+        perror("telemetry");
+        close(listener);
+        return NULL;
+    }
+
+    TelemetryServer* server = new TelemetryServer();
+    server->listener = listener;
+    server->maxBodies = maxBodies;
+    server->interval = 1.0 / rate;
+    server->lastPublish = 0.0;
+    server->numClients = 0;
+    server->hasPending = false;
+
+    bool allocated = true;
+    for (int i = 0; i < 3; i++) {
+        memset(&server->buffers[i], 0, sizeof(TelemetrySnapshot));
+        server->buffers[i].records = (TelemetryRecord*)malloc(sizeof(TelemetryRecord) * (maxBodies > 0 ? maxBodies : 1));
+        allocated = allocated && server->buffers[i].records;
+    }
+    setAccountedMemory(&server->memory, MEMORY_SNAPSHOTS, 3 * sizeof(TelemetryRecord) * (maxBodies > 0 ? maxBodies : 1));
+    server->back = &server->buffers[0];
+    server->pending = &server->buffers[1];
+    server->front = &server->buffers[2];
+
+    if (!allocated) {
+        server->running = false;
+        destroyTelemetryServer(server);
+        return NULL;
+    }
+
+    server->running = true;
+    server->thread = std::thread(runServer, server);
+
+    printf("Telemetry: http://127.0.0.1:%d/ (WebSocket stream at /stream)\n", port);
+    return server;
+}
+
+/**
+ * @brief Stops the server thread and closes every connection
+ */
+void destroyTelemetryServer(TelemetryServer* server) {
+    if (!server) return;
+
+    if (server->running) {
+        server->running = false;
+        server->thread.join();
+    }
+
+    for (int i = server->numClients - 1; i >= 0; i--) {
+        removeClient(server, i);
+    }
+    close(server->listener);
+
+    for (int i = 0; i < 3; i++) {
+        free(server->buffers[i].records);
+    }
+    releaseAccountedMemory(&server->memory);
+    delete server;
+}
+
+/**
+ * @brief Builds a decimated snapshot (simulation thread, rate limited)
+ */
+void publishTelemetry(TelemetryServer* server, const OrbitalSim* sim, const TelemetryStats* stats) {
+    if (!server || !sim) return;
+
+    double now = getWallTime();
+    if (now - server->lastPublish < server->interval) return;
+    server->lastPublish = now;
+
+    TelemetrySnapshot* snapshot = server->back;
+    snapshot->time = sim->time;
+    snapshot->numBodies = sim->numBodies;
+    snapshot->stats = *stats;
+    snapshot->blackHoleActive = sim->blackHole.isActive;
+    snapshot->blackHolePosition = sim->blackHole.position;
+    snapshot->blackHoleMass = sim->blackHole.mass;
+    snapshot->frameOrigin = sim->frameOrigin;
+
+    // System bodies always go out; asteroids are strided to fit maxBodies
+    int asteroids = sim->numBodies - sim->systemBodies;
+    int asteroidBudget = server->maxBodies - sim->systemBodies;
+    int stride = (asteroidBudget > 0) ? (asteroids + asteroidBudget - 1) / asteroidBudget : 0;
+
+    int count = 0;
+    int alive = 0;
+    for (int i = 0; i < sim->numBodies; i++) {
+        if (!sim->bodies[i].isAlive) continue;
+        alive++;
+
+        bool isSystemBody = i < sim->systemBodies;
+        bool sampled = isSystemBody || (stride > 0 && (i - sim->systemBodies) % stride == 0);
+        if (!sampled || count >= server->maxBodies) continue;
+
+        snapshot->records[count].index = (uint32_t)i;
+        snapshot->records[count].position = sim->bodies[i].position;
+        count++;
+    }
+    snapshot->count = count;
+    snapshot->aliveBodies = alive;
+
+    std::lock_guard<std::mutex> guard(server->lock);
+    TelemetrySnapshot* swap = server->pending;
+    server->pending = server->back;
+    server->back = swap;
+    server->hasPending = true;
+}
+
+//***** SERVER THREAD *****//
+
+/**
+ * @brief Accepts clients, answers HTTP and streams snapshots to WebSockets
+ */
+static void runServer(TelemetryServer* server) {
+    struct pollfd fds[TELEMETRY_MAX_CLIENTS + 1];
+
+    while (server->running) {
+        fds[0].fd = server->listener;
+        fds[0].events = POLLIN;
+        for (int i = 0; i < server->numClients; i++) {
+            fds[i + 1].fd = server->clients[i].fd;
+            fds[i + 1].events = POLLIN;
+        }
+
+        int numFds = server->numClients + 1;
+        if (poll(fds, numFds, TELEMETRY_POLL_MS) > 0) {
+            for (int i = numFds - 1; i >= 1; i--) {
+                if (fds[i].revents && !serviceClient(server, &server->clients[i - 1])) {
+                    removeClient(server, i - 1);
+                }
+            }
+            if (fds[0].revents & POLLIN) {
+                acceptClient(server);
+            }
+        }
+
+        bool hasSnapshot = false;
+        {
+            std::lock_guard<std::mutex> guard(server->lock);
+            if (server->hasPending) {
+                TelemetrySnapshot* swap = server->front;
+                server->front = server->pending;
+                server->pending = swap;
+                server->hasPending = false;
+                hasSnapshot = true;
+            }
+        }
+
+        if (hasSnapshot) {
+            broadcastSnapshot(server, server->front);
+        }
+    }
+}
+
+/**
+ * @brief Accepts a pending connection
+ */
+static void acceptClient(TelemetryServer* server) {
+    int fd = accept(server->listener, NULL, NULL);
+    if (fd < 0) return;
+
+    if (server->numClients >= TELEMETRY_MAX_CLIENTS) {
+        close(fd);
+        return;
+    }
+
+    // A stalled client must not block the stream for everybody else
+    struct timeval timeout = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    TelemetryClient* client = &server->clients[server->numClients++];
+    client->fd = fd;
+    client->isWebSocket = false;
+    client->requestLength = 0;
+}
+
+/**
+ * @brief Reads from a client. Returns false when it must be dropped.
+ */
+static bool serviceClient(TelemetryServer* server, TelemetryClient* client) {
+    if (client->isWebSocket) {
+        // Only control frames are expected; a close (opcode 8) ends the stream
+        unsigned char data[256];
+        ssize_t received = recv(client->fd, data, sizeof(data), 0);
+        return received > 0 && (data[0] & 0x0F) != 0x08;
+    }
+
+    int space = TELEMETRY_REQUEST_SIZE - 1 - client->requestLength;
+    ssize_t received = recv(client->fd, client->request + client->requestLength, space, 0);
+    if (received <= 0) return false;
+
+    client->requestLength += (int)received;
+    client->request[client->requestLength] = '\0';
+
+    if (!strstr(client->request, "\r\n\r\n")) {
+        return client->requestLength < TELEMETRY_REQUEST_SIZE - 1;
+    }
+
+    return handleRequest(server, client);
+}
+
+/**
+ * @brief Answers a complete HTTP request. Returns true to keep the connection.
+ */
+static bool handleRequest(TelemetryServer* server, TelemetryClient* client) {
+    char path[256] = "";
+    sscanf(client->request, "GET %255s", path);
+
+    if (!strcmp(path, "/stream")) {
+        const char* keyHeader = strstr(client->request, "Sec-WebSocket-Key:");
+        char key[64] = "";
+        if (!keyHeader || sscanf(keyHeader + strlen("Sec-WebSocket-Key:"), " %63s", key) != 1) {
+            sendText(client->fd, "400 Bad Request", "text/plain", "WebSocket upgrade required\n");
+            return false;
+        }
+
+        char accept[32];
+        computeWebSocketAccept(key, accept);
+
+        char response[256];
+        int length = snprintf(response, sizeof(response),
+            "HTTP/1.1 101 Switching Protocols\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            "Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+
+        client->isWebSocket = sendAll(client->fd, response, length);
+        return client->isWebSocket;
+    }
+
+    if (!strcmp(path, "/")) {
+        char body[512];
+        snprintf(body, sizeof(body),
+            "orbitalsim telemetry\n"
+            "stream: ws://<host>/stream (binary, version %d, little endian)\n"
+            "frame: %d byte header + %d bytes per body\n"
+            "rate: %.1f Hz, max bodies: %d\n"
+            "metrics: http://<host>/metrics (Prometheus text format)\n",
+            TELEMETRY_VERSION, TELEMETRY_HEADER_SIZE, TELEMETRY_RECORD_SIZE,
+            1.0 / server->interval, server->maxBodies);
+        sendText(client->fd, "200 OK", "text/plain", body);
+        return false;
+    }
+
+    if (!strcmp(path, "/metrics")) {
+        char body[8192];
+        formatMetrics(body, sizeof(body));
+        sendText(client->fd, "200 OK", "text/plain; version=0.0.4", body);
+        return false;
+    }
+
+    sendText(client->fd, "404 Not Found", "text/plain", "Not found\n");
+    return false;
+}
+
+/**
+ * @brief Closes a client and compacts the client list
+ */
+static void removeClient(TelemetryServer* server, int index) {
+    close(server->clients[index].fd);
+    server->clients[index] = server->clients[--server->numClients];
+}
+
+/**
+ * @brief Sends a snapshot as one binary WebSocket frame to every stream client
+ */
+static void broadcastSnapshot(TelemetryServer* server, const TelemetrySnapshot* snapshot) {
+    bool hasStreams = false;
+    for (int i = 0; i < server->numClients; i++) {
+        hasStreams = hasStreams || server->clients[i].isWebSocket;
+    }
+    if (!hasStreams) return;
+
+    // Frame header: FIN + binary opcode, then 7/16/64-bit payload length
+    size_t payload = TELEMETRY_HEADER_SIZE + (size_t)snapshot->count * TELEMETRY_RECORD_SIZE;
+    std::vector<unsigned char>& frame = server->frame;
+    frame.resize(10 + payload);
+
+    size_t offset = 0;
+    frame[offset++] = 0x82;
+    if (payload < 126) {
+        frame[offset++] = (unsigned char)payload;
+    }
+    else if (payload <= 0xFFFF) {
+        frame[offset++] = 126;
+        frame[offset++] = (unsigned char)(payload >> 8);
+        frame[offset++] = (unsigned char)payload;
+    }
+    else {
+        frame[offset++] = 127;
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame[offset++] = (unsigned char)((uint64_t)payload >> shift);
+        }
+    }
+
+    size_t size = encodeSnapshot(snapshot, frame, offset);
+
+    for (int i = server->numClients - 1; i >= 0; i--) {
+        if (server->clients[i].isWebSocket && !sendAll(server->clients[i].fd, frame.data(), size)) {
+            removeClient(server, i);
+        }
+    }
+}
+
+/**
+ * @brief Little endian writers
+ */
+static size_t put32(std::vector<unsigned char>& out, size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[offset++] = (unsigned char)(value >> (8 * i));
+    return offset;
+}
+
+static size_t put64(std::vector<unsigned char>& out, size_t offset, uint64_t value) {
+    for (int i = 0; i < 8; i++) out[offset++] = (unsigned char)(value >> (8 * i));
+    return offset;
+}
+
+static size_t putFloat(std::vector<unsigned char>& out, size_t offset, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return put32(out, offset, bits);
+}
+
+static size_t putDouble(std::vector<unsigned char>& out, size_t offset, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return put64(out, offset, bits);
+}
+
+/**
+ * @brief Serializes a snapshot in the layout documented in telemetry.h
+ */
+static size_t encodeSnapshot(const TelemetrySnapshot* snapshot, std::vector<unsigned char>& out, size_t offset) {
+    offset = put32(out, offset, TELEMETRY_MAGIC);
+    out[offset++] = (unsigned char)(TELEMETRY_VERSION & 0xFF);
+    out[offset++] = (unsigned char)(TELEMETRY_VERSION >> 8);
+    out[offset++] = 0;
+    out[offset++] = 0;
+    offset = putDouble(out, offset, snapshot->time);
+    offset = put32(out, offset, (uint32_t)snapshot->numBodies);
+    offset = put32(out, offset, (uint32_t)snapshot->aliveBodies);
+    offset = put32(out, offset, (uint32_t)snapshot->count);
+    offset = putFloat(out, offset, snapshot->stats.fps);
+    offset = putFloat(out, offset, snapshot->stats.physicsMs);
+    offset = putFloat(out, offset, snapshot->stats.renderMs);
+    offset = put32(out, offset, (uint32_t)snapshot->stats.renderedPlanets);
+    offset = put32(out, offset, (uint32_t)snapshot->stats.renderedAsteroids);
+    out[offset++] = snapshot->blackHoleActive ? 1 : 0;
+    offset = putFloat(out, offset, snapshot->blackHolePosition.x);
+    offset = putFloat(out, offset, snapshot->blackHolePosition.y);
+    offset = putFloat(out, offset, snapshot->blackHolePosition.z);
+    offset = putDouble(out, offset, snapshot->blackHoleMass);
+    offset = putFloat(out, offset, snapshot->frameOrigin.x);
+    offset = putFloat(out, offset, snapshot->frameOrigin.y);
+    offset = putFloat(out, offset, snapshot->frameOrigin.z);
+
+    for (int i = 0; i < snapshot->count; i++) {
+        const TelemetryRecord* record = &snapshot->records[i];
+        offset = put32(out, offset, record->index);
+        offset = putFloat(out, offset, record->position.x);
+        offset = putFloat(out, offset, record->position.y);
+        offset = putFloat(out, offset, record->position.z);
+    }
+
+    return offset;
+}
+
+/**
+ * @brief Writes a whole buffer to a socket
+ */
+static bool sendAll(int fd, const void* data, size_t size) {
+    const char* bytes = (const char*)data;
+    while (size > 0) {
+        ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+/**
+ * @brief Sends a complete HTTP response
+ */
+static bool sendText(int fd, const char* status, const char* contentType, const char* body) {
+    char header[256];
+    int length = snprintf(header, sizeof(header),
+        "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %d\r\nConnection: close\r\n\r\n",
+        status, contentType, (int)strlen(body));
+    return sendAll(fd, header, length) && sendAll(fd, body, strlen(body));
+}
+
+/**
+ * @brief Sec-WebSocket-Accept = base64(SHA-1(key + GUID)), RFC 6455
+ */
+static void computeWebSocketAccept(const char* key, char* accept) {
+    char buffer[128];
+    int length = snprintf(buffer, sizeof(buffer), "%s258EAFA5-E914-47DA-95CA-C5AB0DC85B11", key);
+
+    unsigned char digest[20];
+    sha1((const unsigned char*)buffer, length, digest);
+    base64(digest, sizeof(digest), accept);
+}
+
+/**
+ * @brief SHA-1 (only used for the WebSocket handshake)
+ */
+static void sha1(const unsigned char* data, size_t size, unsigned char digest[20]) {
+    uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+    size_t paddedSize = ((size + 8) / 64 + 1) * 64;
+    std::vector<unsigned char> message(paddedSize, 0);
+    memcpy(message.data(), data, size);
+    message[size] = 0x80;
+    uint64_t bits = (uint64_t)size * 8;
+    for (int i = 0; i < 8; i++) {
+        message[paddedSize - 1 - i] = (unsigned char)(bits >> (8 * i));
+    }
+
+    for (size_t chunk = 0; chunk < paddedSize; chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const unsigned char* p = &message[chunk + 4 * i];
+            w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+        }
+        for (int i = 16; i < 80; i++) {
+            uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+            w[i] = (x << 1) | (x >> 31);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+
+            uint32_t temp = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = (b << 30) | (b >> 2);
+            b = a;
+            a = temp;
+        }
+
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    for (int i = 0; i < 20; i++) {
+        digest[i] = (unsigned char)(h[i / 4] >> (24 - 8 * (i % 4)));
+    }
+}
+
+/**
+ * @brief Standard base64 with padding
+ */
+static void base64(const unsigned char* data, size_t size, char* out) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    size_t o = 0;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t group = (uint32_t)data[i] << 16;
+        if (i + 1 < size) group |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < size) group |= data[i + 2];
+
+        out[o++] = alphabet[(group >> 18) & 0x3F];
+        out[o++] = alphabet[(group >> 12) & 0x3F];
+        out[o++] = (i + 1 < size) ? alphabet[(group >> 6) & 0x3F] : '=';
+        out[o++] = (i + 2 < size) ? alphabet[group & 0x3F] : '=';
+    }
+    out[o] = '\0';
+}
+
+#else
+
+// Sockets are POSIX-only here: telemetry is disabled
+
+struct TelemetryServer {
+    int unused;
+};
+
+TelemetryServer* constructTelemetryServer(int port, float rate, int maxBodies) {
+    printf("Telemetry is not supported on this platform\n");
+    return NULL;
+}
+
+void destroyTelemetryServer(TelemetryServer* server) {
+    delete server;
+}
+
+void publishTelemetry(TelemetryServer* server, const OrbitalSim* sim, const TelemetryStats* stats) {
+}
+
+#endif
+
+//***** STATIC HELPERS *****//
+
+/**
+ * @brief Monotonic wall clock in seconds
+ */
+static double getWallTime(void) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,51 @@
+/**
+ * @brief Implements a loopback HTTP/WebSocket telemetry endpoint
+ * @author Dylan Frigerio, Luca Forchiassin
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#include "orbitalSim.h"
+
+#define TELEMETRY_MAGIC 0x4D4C544F // "OTLM"
+#define TELEMETRY_VERSION 2
+
+/**
+ * @brief HUD and profiler figures sent with every snapshot
+ */
+struct TelemetryStats {
+    float fps;
+    float physicsMs;         // Time spent in simulation updates last frame
+    float renderMs;          // Time spent rendering last frame
+    int renderedPlanets;
+    int renderedAsteroids;
+};
+
+/**
+ * @brief Binary frame header (little endian, packed by hand in the encoder).
+ * Followed by bodyCount records of { uint32 index; float x, y, z; }.
+ *
+ * uint32 magic, uint16 version, uint16 flags, float64 time,
+ * uint32 numBodies, uint32 aliveBodies, uint32 bodyCount,
+ * float32 fps, physicsMs, renderMs, uint32 renderedPlanets, renderedAsteroids,
+ * uint8 blackHoleActive, float32 x, y, z, float64 blackHoleMass,
+ * float32 originX, originY, originZ
+ *
+ * Positions are relative to the origin (in the ephemeris frame; it is 0
+ * unless the simulation runs in the heliocentric frame).
+ */
+#define TELEMETRY_HEADER_SIZE 81
+#define TELEMETRY_RECORD_SIZE 16
+
+struct TelemetryServer;
+
+TelemetryServer* constructTelemetryServer(int port, float rate, int maxBodies);
+void destroyTelemetryServer(TelemetryServer* server);
+void publishTelemetry(TelemetryServer* server, const OrbitalSim* sim, const TelemetryStats* stats);
+
+#endif
@@ -9,13 +9,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "asyncReset.h"
+#include "eventLog.h"
+#include "memoryStats.h"
+#include "metrics.h"
+#include "renderSnapshot.h"
 #include "view.h"
 #include "raymath.h"
 
 #define WINDOW_WIDTH 1280
 #define WINDOW_HEIGHT 720
-#define SCALE_FACTOR 1E-11F
-#define RADIUS_SCALE(r) (0.005F * logf(r))
 
  // UI Colors and styling
 #define UI_PRIMARY_COLOR Color{0, 255, 255, 255}      // Cyan
@@ -36,6 +39,9 @@
 #define BUTTON_SPACING 8
 #define STAT_BOX_SIZE 120
 
+#define ASTEROID_COUNT_DIGITS 8      // Up to 99,999,999 asteroids
+#define FORECAST_INTERVAL 0.5        // Seconds between capacity checks
+
 // Menu state structure
 typedef struct {
     bool isOpen;
@@ -47,11 +53,13 @@ typedef struct {
     float confirmDialogTimer;
 
     // Asteroid controls
-    char asteroidCountText[8];  // String for text input
+    char asteroidCountText[ASTEROID_COUNT_DIGITS + 1];  // String for text input
     int asteroidCount;          // Actual number
     bool asteroidInputActive;   // Is text field being edited
     int cursorPosition;         // Cursor position in text field
     float cursorBlinkTimer;     // Cursor blink animation
+
+    bool resetFailed;           // Last reset could not be built
 } MenuState;
 
 // UI Animation state
@@ -75,7 +83,8 @@ static MenuState menuState = {
     1000,                    // asteroidCount
     false,                   // asteroidInputActive
     4,                       // cursorPosition
-    0.0f                     // cursorBlinkTimer
+    0.0f,                    // cursorBlinkTimer
+    false                    // resetFailed
 };
 
 typedef struct {
@@ -86,15 +95,35 @@ typedef struct {
 	Vector3 relativePosition;  // relative position to camera
     float rotationSpeed;
     bool isInitialized;
+    MemoryAccount memory;      // Model data reported to the memory counters
 } ShipRenderer;
 
 // global ship renderer instance
 static ShipRenderer shipRenderer = { 0 };
 
+// Simulation being built by the menu, swapped in by renderView when ready
+static AsyncReset* pendingReset = NULL;
+
+// Memory and throughput check of the menu selection
+typedef struct {
+    int asteroidCount;         // Selection the check was made for
+    SystemType system;
+    double checkTime;
+    size_t bytes;              // Simulation plus render snapshot
+    size_t available;          // Physical memory available, 0 if unknown
+    bool fits;
+    bool hasForecast;
+    ThroughputForecast forecast;
+} CapacityCheck;
+
+static CapacityCheck capacityCheck = { -1, SYSTEM_TYPE_SOLAR, 0.0, 0, 0, false, false, {} };
+static int targetFps = 60;
+
 // Forward declarations for UI functions
 static void DrawEnhancedTopHUD(OrbitalSim* sim, float timestamp);
 static void DrawEnhancedLeftPanel(OrbitalSim* sim, float lodMultiplier, int rendered_planets, int rendered_asteroids);
 static void DrawEnhancedRightPanel(void);
+static void DrawMemoryPanel(void);
 static void DrawEnhancedBottomHUD(int fps);
 static void DrawPanelBackground(Rectangle rect, Color color);
 static void DrawStatBox(Rectangle rect, const char* value, const char* label, Color accentColor);
@@ -106,11 +135,13 @@ static void DrawMainMenu(OrbitalSim* sim);
 static void HandleMenuInput(OrbitalSim* sim);
 static void HandleTextInput(void);
 static void InitializeSystem(OrbitalSim* sim);
+static void UpdateCapacityCheck(const OrbitalSim* sim);
 static void InitializeShip(void);
 static void UpdateShipRotation(float deltaTime);
 static Vector3 CalculateShipWorldPosition(Camera3D* camera);
 static void RenderShip(Camera3D* camera);
 static void CleanupShip(void);
+static size_t GetModelBytes(Model model);
 
 /**
  * @brief Converts a timestamp to an ISO date
@@ -135,6 +166,7 @@ View* constructView(int fps) {
 
     InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "EDA Orbital Simulation - Enhanced");
     SetTargetFPS(fps);
+    targetFps = fps;
     DisableCursor();
 
     view->camera.position = { 15.0f, 15.0f, 15.0f };
@@ -142,6 +174,9 @@ View* constructView(int fps) {
     view->camera.up = { 0.0f, 1.0f, 0.0f };
     view->camera.fovy = 45.0f;
     view->camera.projection = CAMERA_PERSPECTIVE;
+    view->renderedPlanets = 0;
+    view->renderedAsteroids = 0;
+    view->snapshot = constructRenderSnapshot();
 
     if (!shipLoaded) {
         ship = LoadModel("assets/Ufo.obj");
@@ -157,6 +192,9 @@ View* constructView(int fps) {
 void destroyView(View* view) {
     CleanupShip();  
     CloseWindow();
+    cancelAsyncReset(pendingReset);
+    pendingReset = NULL;
+    destroyRenderSnapshot(view->snapshot);
     delete view;
 }
 
@@ -184,6 +222,21 @@ void renderView(View* view, OrbitalSim* sim, int reset) {
         return;
     }
 
+    // Swap in the simulation built by the menu (the old one rendered until now)
+    if (pendingReset && isAsyncResetReady(pendingReset)) {
+        AsyncReset* built = pendingReset;
+        pendingReset = NULL;
+        if (finishAsyncReset(built, sim)) {
+            menuState.isOpen = false;
+            menuState.asteroidInputActive = false;
+            timestamp = 0.0f;
+            DisableCursor();
+        }
+        else {
+            menuState.resetFailed = true;
+        }
+    }
+
     // Update UI animations
     uiAnim.uiTime = GetTime();
     uiAnim.rotation += 45.0f * GetFrameTime();
@@ -209,9 +262,13 @@ void renderView(View* view, OrbitalSim* sim, int reset) {
 
     // Handle input only when menu is not open
     if (!menuState.isOpen) {
+        float previousLod = lodMultiplier;
         if (IsKeyPressed(KEY_ONE)) lodMultiplier *= 1.2f;
         if (IsKeyPressed(KEY_TWO)) lodMultiplier *= 0.8f;
         if (IsKeyPressed(KEY_R)) lodMultiplier = 1.0f;
+        if (lodMultiplier != previousLod) {
+            logEvent(EVENT_LOD_CHANGE, 0, sim->time, lodMultiplier, 0.0);
+        }
 
         if (IsKeyPressed(KEY_K) && !sim->blackHole.isActive) {
 			Vector3 shipPos = CalculateShipWorldPosition(&view->camera);
@@ -244,34 +301,37 @@ void renderView(View* view, OrbitalSim* sim, int reset) {
     int rendered_planets = 0;
     int rendered_asteroids = 0;
 
-    // Render celestial bodies with LOD
-    for (int i = 0; i < sim->numBodies; i++) {
-        OrbitalBody& body = sim->bodies[i];
-        if (!body.isAlive) continue;
+    // Render celestial bodies with LOD (from the quantized snapshot)
+    const RenderSnapshot* snapshot = view->snapshot;
+    int moonsEnd = snapshot->count + snapshot->satelliteCount;
+    for (int i = 0; i < moonsEnd + snapshot->ringCount; i++) {
+        const RenderBody& body = snapshot->bodies[i];
+        if (body.palette == RENDER_HIDDEN) continue;
 
-        Vector3 scaledPosition = Vector3Scale(body.position, SCALE_FACTOR);
+        Vector3 scaledPosition = getRenderPosition(snapshot, &body);
         float distance = Vector3Distance(view->camera.position, scaledPosition);
+        Color color = snapshot->palette[body.palette];
 
-        if (i < sim->systemBodies) { // System bodies (planets/stars)
+        if (i < snapshot->systemBodies || (i >= snapshot->count && i < moonsEnd)) { // System bodies (planets/stars) and moons
             if (distance > PLANET_LOD_CULL) continue;
-            float radius = RADIUS_SCALE(body.radius);
+            float radius = body.radiusClass * RENDER_RADIUS_QUANTUM;
             float relativeDistance = distance / PLANET_LOD_CULL;
 
             if (relativeDistance < 0.1f) {
-                DrawSphere(scaledPosition, radius, body.color);
+                DrawSphere(scaledPosition, radius, color);
             }
             else if (relativeDistance < 0.4f) {
-                DrawSphereEx(scaledPosition, radius * 0.95f, 16, 16, body.color);
+                DrawSphereEx(scaledPosition, radius * 0.95f, 16, 16, color);
             }
             else if (relativeDistance < 0.8f) {
-                DrawSphereEx(scaledPosition, radius * 0.8f, 8, 8, body.color);
+                DrawSphereEx(scaledPosition, radius * 0.8f, 8, 8, color);
             }
             else {
-                DrawSphereEx(scaledPosition, radius * 0.7f, 6, 6, body.color);
+                DrawSphereEx(scaledPosition, radius * 0.7f, 6, 6, color);
             }
             rendered_planets++;
         }
-        else { // Asteroids
+        else { // Asteroids and ring particles
             if (distance > LOD_CULL) continue;
             float relativeDistance = distance / LOD_CULL;
             float lodFactor = (relativeDistance > 0.8f) ? 0.05f :
@@ -279,15 +339,15 @@ void renderView(View* view, OrbitalSim* sim, int reset) {
 
 			// Deterministic random bit generator for rendering decision
             if (((i * 73 + 17) % 1000) < (int)(lodFactor * 1000)) {
-                float asteroidRadius = RADIUS_SCALE(body.radius) * 0.3f;
+                float asteroidRadius = body.radiusClass * RENDER_RADIUS_QUANTUM * 0.3f;
                 if (relativeDistance < 0.3f) {
-                    DrawSphereEx(scaledPosition, asteroidRadius, 5, 5, body.color);
+                    DrawSphereEx(scaledPosition, asteroidRadius, 5, 5, color);
                 }
                 else if (relativeDistance < 0.7f) {
-                    DrawSphereEx(scaledPosition, asteroidRadius * 0.6f, 3, 3, body.color);
+                    DrawSphereEx(scaledPosition, asteroidRadius * 0.6f, 3, 3, color);
                 }
                 else {
-                    DrawPoint3D(scaledPosition, body.color);
+                    DrawPoint3D(scaledPosition, color);
                 }
                 rendered_asteroids++;
             }
@@ -352,8 +412,11 @@ void renderView(View* view, OrbitalSim* sim, int reset) {
     DrawGrid(10, 10.0f);
     EndMode3D();
 
+    view->renderedPlanets = rendered_planets;
+    view->renderedAsteroids = rendered_asteroids;
+
     // Update timestamp
-    timestamp += sim->timeStep * UPDATEPERFRAME;
+    timestamp = (float)sim->time;
 
 	static bool f3PressedLastFrame = true;
     if (IsKeyPressed(KEY_F3)) f3PressedLastFrame = !f3PressedLastFrame;
@@ -367,6 +430,7 @@ void renderView(View* view, OrbitalSim* sim, int reset) {
         {
             DrawEnhancedLeftPanel(sim, lodMultiplier, rendered_planets, rendered_asteroids);
             DrawEnhancedRightPanel();
+            DrawMemoryPanel();
         }
         DrawEnhancedBottomHUD(GetFPS());
     }
@@ -387,7 +451,7 @@ static void HandleTextInput(void) {
 
     // Handle character input
     while (key > 0) {
-        if (key >= 48 && key <= 57 && strlen(menuState.asteroidCountText) < 6) { // Numbers 0-9
+        if (key >= 48 && key <= 57 && strlen(menuState.asteroidCountText) < ASTEROID_COUNT_DIGITS) { // Numbers 0-9
             int len = strlen(menuState.asteroidCountText);
             if (menuState.cursorPosition <= len) {
                 // Insert character at cursor position
@@ -438,14 +502,9 @@ static void HandleTextInput(void) {
         menuState.cursorPosition = strlen(menuState.asteroidCountText);
     }
 
-    // Update asteroid count from text
+    // Update asteroid count from text (validated by UpdateCapacityCheck)
     int newCount = atoi(menuState.asteroidCountText);
     if (newCount < 0) newCount = 0;
-    if (newCount > 5000) {
-        newCount = 5000;
-        strcpy(menuState.asteroidCountText, "5000");
-        menuState.cursorPosition = 4;
-    }
     menuState.asteroidCount = newCount;
 
     // Deactivate input if Enter is pressed or clicked outside
@@ -463,8 +522,14 @@ static void InitializeShip(void) {
     // Loading space model
     shipRenderer.model = LoadModel("assets/Ufo.obj");
     shipRenderer.isLoaded = IsModelValid(shipRenderer.model);
+    logEvent(shipRenderer.isLoaded ? EVENT_MODEL_LOADED : EVENT_MODEL_FAILED, 0, 0.0, 0.0, 0.0);
 
     if (shipRenderer.isLoaded) {
+        // raylib keeps a CPU copy of what it uploads
+        size_t modelBytes = GetModelBytes(shipRenderer.model);
+        setAccountedMemory(&shipRenderer.memory, MEMORY_ASSETS, modelBytes);
+        setAccountedMemory(&shipRenderer.memory, MEMORY_GPU_BUFFERS, modelBytes);
+
 		// Setting material properties
         for (int i = 0; i < shipRenderer.model.materialCount; i++) {
            
@@ -473,14 +538,6 @@ static void InitializeShip(void) {
             
             shipRenderer.model.materials[i].shader = LoadShader(NULL, NULL); 
         }
-        if (shipRenderer.isLoaded) {
-            printf("Modelo cargado correctamente\n");
-        }
-        else {
-            printf("Error: No se pudo cargar el modelo Ufo.obj\n");
-            printf("Verifica que el archivo existe en: assets/Ufo.obj\n");
-        }
-
         for (int i = 0; i < shipRenderer.model.meshCount; i++) {
             if (shipRenderer.model.meshes[i].tangents == NULL) {
                 GenMeshTangents(&shipRenderer.model.meshes[i]);
@@ -557,9 +614,26 @@ static void CleanupShip(void) {
         UnloadModel(shipRenderer.model);
         shipRenderer.isLoaded = false;
     }
+    releaseAccountedMemory(&shipRenderer.memory);
     shipRenderer.isInitialized = false;
 }
 
+/**
+ * @brief Estimates the vertex and index bytes of a model
+ */
+static size_t GetModelBytes(Model model) {
+    size_t bytes = 0;
+    for (int i = 0; i < model.meshCount; i++) {
+        Mesh* mesh = &model.meshes[i];
+        size_t floatsPerVertex = 3 + (mesh->normals ? 3 : 0) + (mesh->texcoords ? 2 : 0) +
+            (mesh->texcoords2 ? 2 : 0) + (mesh->tangents ? 4 : 0);
+        bytes += sizeof(float) * floatsPerVertex * mesh->vertexCount;
+        if (mesh->colors) bytes += 4 * (size_t)mesh->vertexCount;
+        if (mesh->indices) bytes += sizeof(unsigned short) * 3 * (size_t)mesh->triangleCount;
+    }
+    return bytes;
+}
+
 /**
  * @brief Handle menu input
  */
@@ -662,7 +736,7 @@ static void DrawMainMenu(OrbitalSim* sim) {
         menuState.asteroidInputActive = false;
     }
 
-    DrawTextInput(asteroidInput, menuState.asteroidCountText, menuState.asteroidInputActive, "Count (0-5000)");
+    DrawTextInput(asteroidInput, menuState.asteroidCountText, menuState.asteroidInputActive, "Count");
 
     // Dispersion selection
     DrawText("Dispersion:", menuPanel.x + 200, yPos - 15, 14, UI_TEXT_SECONDARY);
@@ -700,6 +774,24 @@ static void DrawMainMenu(OrbitalSim* sim) {
         getDispersionRange(menuState.selectedDispersion) >= 1E12F ? "12" : "11"),
         menuPanel.x + 200, yPos, 12, UI_TEXT_SECONDARY);
 
+    // Memory and performance forecast of the selected count
+    UpdateCapacityCheck(sim);
+    double megabytes = capacityCheck.bytes / (1024.0 * 1024.0);
+    if (!capacityCheck.fits) {
+        DrawText(TextFormat("Needs %.0f MB: not enough memory (%.0f MB available)", megabytes,
+            capacityCheck.available / (1024.0 * 1024.0)), menuPanel.x + 50, yPos + 18, 12, UI_ERROR_COLOR);
+    }
+    else if (capacityCheck.hasForecast) {
+        Color forecastColor = (capacityCheck.forecast.fps >= 30.0) ? UI_SUCCESS_COLOR :
+            (capacityCheck.forecast.fps >= 10.0) ? UI_WARNING_COLOR : UI_ERROR_COLOR;
+        DrawText(TextFormat("Forecast: %.0f MB, ~%.0f steps/s, ~%.0f FPS", megabytes,
+            capacityCheck.forecast.stepsPerSecond, capacityCheck.forecast.fps), menuPanel.x + 50, yPos + 18, 12, forecastColor);
+    }
+    else {
+        DrawText(TextFormat("Forecast: %.0f MB (measuring throughput...)", megabytes),
+            menuPanel.x + 50, yPos + 18, 12, UI_TEXT_SECONDARY);
+    }
+
     yPos += 40;
 
     // Easter egg selection
@@ -737,16 +829,12 @@ static void DrawMainMenu(OrbitalSim* sim) {
     bool resetPressed = IsMouseInside(resetBtn) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
     bool closePressed = IsMouseInside(closeBtn) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
 
-    DrawButton(applyBtn, "APPLY", applyPressed, UI_SUCCESS_COLOR);
+    DrawButton(applyBtn, "APPLY", applyPressed, capacityCheck.fits ? UI_SUCCESS_COLOR : UI_TEXT_SECONDARY);
     DrawButton(resetBtn, "RESET", resetPressed, UI_ERROR_COLOR);
     DrawButton(closeBtn, "CLOSE", closePressed, UI_SECONDARY_COLOR);
 
     if (applyPressed) {
         InitializeSystem(sim);
-        menuState.isOpen = false;
-        menuState.asteroidInputActive = false;
-		renderView(0, sim, 1); // Reset timestamp
-        DisableCursor();
     }
 
     if (resetPressed || menuState.showConfirmReset) {
@@ -786,13 +874,9 @@ static void DrawMainMenu(OrbitalSim* sim) {
         }
 
         if (yesPressed) {
-            InitializeSystem(sim);
-            menuState.isOpen = false;
             menuState.showConfirmReset = false;
-            menuState.asteroidInputActive = false;
             menuState.confirmDialogTimer = 0.0f;  // Reset timer
-            renderView(0, sim, 1); // Reset timestamp
-            DisableCursor();
+            InitializeSystem(sim);
         }
 
         if (noPressed) {
@@ -807,23 +891,82 @@ static void DrawMainMenu(OrbitalSim* sim) {
         DisableCursor();
     }
 
+    if (pendingReset) {
+        float progress = getAsyncResetProgress(pendingReset);
+        Rectangle bar = { menuPanel.x + 50, menuPanel.y + 578, 300, 14 };
+        DrawRectangleRec(bar, Color{ 30, 40, 60, 255 });
+        DrawRectangle(bar.x, bar.y, (int)(bar.width * progress), bar.height, UI_PRIMARY_COLOR);
+        DrawText(TextFormat("Building simulation... %d%%", (int)(progress * 100)), bar.x + bar.width + 15, bar.y + 1, 12, UI_TEXT_PRIMARY);
+    }
+    else if (menuState.resetFailed) {
+        DrawText("Not enough memory for this configuration: current simulation kept",
+            menuPanel.x + 50, menuPanel.y + 580, 12, UI_ERROR_COLOR);
+    }
+
     // Instructions
     DrawText("Press M to open/close menu | F5 for quick reset", menuPanel.x + 50, menuPanel.y + 600, 12, UI_TEXT_SECONDARY);
     DrawText("Click on asteroid count field to edit | Use arrow keys to move cursor", menuPanel.x + 50, menuPanel.y + 615, 12, UI_TEXT_SECONDARY);
 }
 
 /**
- * @brief Initialize system based on menu selection
+ * @brief Starts building a system from the menu selection on a background
+ * thread. renderView swaps it in when ready.
  */
 static void InitializeSystem(OrbitalSim* sim) {
+    if (pendingReset) return; // One reset at a time
+    if (!capacityCheck.fits) return;
+
     SimConfig newConfig = {
         menuState.selectedSystem,
         menuState.selectedEasterEgg,
         menuState.selectedDispersion,
-        menuState.asteroidCount
+        menuState.asteroidCount,
+        sim->config.hugePages,
+        sim->config.driftSteps,
+        sim->config.ringParticles,
+        sim->config.collisions,
+        sim->config.encounterHillRadii,
+        sim->config.hybrid,
+        sim->config.forceTerms,
+        sim->config.frame,
+        sim->config.compensated,
+        sim->config.fastInverseSqrt,
+        sim->config.isa
     };
 
-    resetOrbitalSim(sim, &newConfig);
+    menuState.resetFailed = false;
+    pendingReset = startAsyncReset(sim, &newConfig);
+}
+
+/**
+ * @brief Checks the menu selection against the available memory and
+ * forecasts its throughput from the measured step and render costs.
+ * Refreshed when the selection changes and every FORECAST_INTERVAL.
+ */
+static void UpdateCapacityCheck(const OrbitalSim* sim) {
+    double now = GetTime();
+    if (capacityCheck.asteroidCount == menuState.asteroidCount &&
+        capacityCheck.system == menuState.selectedSystem &&
+        now - capacityCheck.checkTime < FORECAST_INTERVAL) return;
+
+    SimConfig config = { menuState.selectedSystem, menuState.selectedEasterEgg,
+        menuState.selectedDispersion, menuState.asteroidCount, false, 1, sim->config.ringParticles,
+        sim->config.collisions, sim->config.encounterHillRadii, sim->config.hybrid, sim->config.forceTerms,
+        sim->config.frame, sim->config.compensated, sim->config.fastInverseSqrt,
+        sim->config.isa };
+    int bodies = getSystemBodyCount(menuState.selectedSystem) + menuState.asteroidCount;
+
+    capacityCheck.asteroidCount = menuState.asteroidCount;
+    capacityCheck.system = menuState.selectedSystem;
+    capacityCheck.checkTime = now;
+    size_t entries = (size_t)bodies + getSystemRingParticles(&config);
+    capacityCheck.bytes = getOrbitalSimBytes(&config) + sizeof(RenderBody) * entries;
+    capacityCheck.available = getAvailableMemory();
+
+    // The current simulation stays alive while the new one is built
+    capacityCheck.fits = fitsMemoryLimit(capacityCheck.bytes) &&
+        (capacityCheck.available == 0 || capacityCheck.bytes <= capacityCheck.available);
+    capacityCheck.hasForecast = forecastThroughput(bodies, UPDATEPERFRAME, targetFps, &capacityCheck.forecast);
 }
 
 /**
@@ -984,6 +1127,35 @@ static void DrawEnhancedRightPanel(void) {
     }
 }
 
+/**
+ * @brief Draw memory usage per subsystem
+ */
+static void DrawMemoryPanel(void) {
+    Rectangle panel = { WINDOW_WIDTH - 280 - PANEL_MARGIN, 440, 280, 200 };
+    DrawPanelBackground(panel, UI_PANEL_BG);
+
+    DrawText("MEMORY", panel.x + 105, panel.y + 15, 18, UI_PRIMARY_COLOR);
+
+    float yPos = panel.y + 45;
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+        MemorySubsystem subsystem = (MemorySubsystem)i;
+        DrawText(getMemorySubsystemName(subsystem), panel.x + 20, yPos, 12, UI_TEXT_SECONDARY);
+        DrawText(TextFormat("%.2f MB", getMemoryUsage(subsystem) / (1024.0 * 1024.0)), panel.x + 170, yPos, 12, UI_TEXT_PRIMARY);
+        yPos += 18;
+    }
+
+    double total = getTotalMemoryUsage() / (1024.0 * 1024.0);
+    size_t limit = getMemoryLimit();
+    if (limit > 0) {
+        double used = total * 1024.0 * 1024.0 / limit;
+        Color color = (used < 0.75) ? UI_SUCCESS_COLOR : (used < 0.9) ? UI_WARNING_COLOR : UI_ERROR_COLOR;
+        DrawText(TextFormat("TOTAL %.1f / %.0f MB", total, limit / (1024.0 * 1024.0)), panel.x + 20, yPos + 6, 14, color);
+    }
+    else {
+        DrawText(TextFormat("TOTAL %.1f MB", total), panel.x + 20, yPos + 6, 14, UI_TEXT_PRIMARY);
+    }
+}
+
 /**
  * @brief Draw enhanced bottom HUD
  */
@@ -10,6 +10,7 @@
 
 #include <raylib.h>
 #include "orbitalSim.h"
+#include "renderSnapshot.h"
 #define UPDATEPERFRAME 10
 
  /**
@@ -18,6 +19,9 @@
 struct View
 {
     Camera3D camera;
+    int renderedPlanets;    // Bodies drawn in the last frame
+    int renderedAsteroids;
+    RenderSnapshot* snapshot;   // Filled by the caller before renderView
 };
 
 View* constructView(int fps);